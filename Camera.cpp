@@ -3,6 +3,7 @@
 #include <glm/ext/quaternion_geometric.hpp>
 #include <glm/fwd.hpp>
 #include <iostream>
+#include "Tracer.h"
 
 Camera* Camera::instance = nullptr;
 
@@ -57,8 +58,10 @@ void Camera::ProcessMouseMovement(float xpos, float ypos) {
     UpdateCameraVectors();
 }
 
-void Camera::ProcessKeyboard(GLFWwindow* window) {
-    float cameraSpeed = 0.5f;
+void Camera::ProcessKeyboard(GLFWwindow* window, float deltaTime) {
+    TRACE_SCOPE("ProcessKeyboard");
+    // unidades por segundo (equivale aos antigos 0.5 por frame a 60 FPS)
+    float cameraSpeed = 30.0f * deltaTime;
 
     glm::vec3 delta;
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
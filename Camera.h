@@ -12,7 +12,7 @@ public:
     Camera(float width, float height, float x, float y, float z);
     
     void ProcessMouseMovement(float xpos, float ypos);
-    void ProcessKeyboard(GLFWwindow* window);
+    void ProcessKeyboard(GLFWwindow* window, float deltaTime);
     
     glm::mat4 GetViewMatrix() const;
     glm::mat4 GetProjectionMatrix() const;
@@ -0,0 +1,297 @@
+// DeferredRenderer.cpp
+#include "DeferredRenderer.h"
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Shader.h"
+#include "Tracer.h"
+
+namespace {
+
+const float kMaxLightRadius = 250.0f;
+
+// Distância em que a contribuição da luz cai abaixo de 1/256 (invisível em 8 bits).
+// Resolve c + l*d + q*d² = intensidade máxima * 256 para d.
+float LightRadius(const glm::vec3& color, float constant, float linear, float quadratic) {
+    float brightest = std::max(color.r, std::max(color.g, color.b)) * 1.6f;  // diffuse + specular
+    float target = brightest * 256.0f;
+    if (target <= constant)
+        return 0.0f;
+
+    float radius;
+    if (quadratic > 0.0f)
+        radius = (-linear + std::sqrt(linear * linear - 4.0f * quadratic * (constant - target))) / (2.0f * quadratic);
+    else if (linear > 0.0f)
+        radius = (target - constant) / linear;
+    else
+        radius = kMaxLightRadius;
+    return std::min(radius, kMaxLightRadius);
+}
+
+void SetVec3(GLuint program, const char* name, const glm::vec3& value) {
+    glUniform3fv(glGetUniformLocation(program, name), 1, glm::value_ptr(value));
+}
+
+void SetFloat(GLuint program, const char* name, float value) {
+    glUniform1f(glGetUniformLocation(program, name), value);
+}
+
+} // namespace
+
+void DeferredRenderer::Initialize(int width, int height) {
+    this->width = width;
+    this->height = height;
+
+    BuildPrograms();
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+    // normal e albedo em half float; coeficientes de material cabem em 8 bits
+    const GLenum internalFormats[4] = {GL_RGBA16F, GL_RGBA16F, GL_RGBA8, GL_RGBA8};
+    GLenum drawBuffers[4];
+    glGenTextures(4, targets);
+    for (int i = 0; i < 4; i++) {
+        glBindTexture(GL_TEXTURE_2D, targets[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormats[i], width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, targets[i], 0);
+        drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+    }
+    glDrawBuffers(4, drawBuffers);
+
+    // mesmo formato do framebuffer padrão, para o blit de profundidade antes do céu
+    glGenTextures(1, &depthTexture);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        throw std::runtime_error("G-buffer framebuffer incomplete: " + std::to_string(status));
+    }
+
+    glGenVertexArrays(1, &fullscreenVao);
+    CreateSphere();
+}
+
+void DeferredRenderer::BuildPrograms() {
+    // 0: geometria; 1-2: direcional sem/com sombras; 3-4: volumes de luz sem/com sombras
+    GLuint built[5] = {0, 0, 0, 0, 0};
+    try {
+        built[0] = CreateProgram(loadShaderFromFile("vs.glsl"), loadShaderFromFile("gbuffer_fs.glsl"));
+        std::string shadow = loadShaderFromFile("shadow.glsl");
+        std::string directionalSource = InsertAfterVersion(loadShaderFromFile("deferred_dir_fs.glsl"), shadow);
+        std::string lightSource = InsertAfterVersion(loadShaderFromFile("deferred_light_fs.glsl"), shadow);
+        for (int i = 0; i < 2; i++) {
+            std::string defines = i == 0 ? "#define NO_SHADOWS\n" : "";
+            built[1 + i] = CreateProgram(loadShaderFromFile("fullscreen_vs.glsl"),
+                    InsertAfterVersion(directionalSource, defines));
+            built[3 + i] = CreateProgram(loadShaderFromFile("deferred_light_vs.glsl"),
+                    InsertAfterVersion(lightSource, defines));
+        }
+    } catch (...) {
+        for (GLuint program : built) {
+            if (program) glDeleteProgram(program);
+        }
+        throw;
+    }
+
+    DeletePrograms();
+    geometryProgram = built[0];
+    for (int i = 0; i < 2; i++) {
+        directionalPrograms[i] = built[1 + i];
+        lightPrograms[i] = built[3 + i];
+    }
+}
+
+void DeferredRenderer::DeletePrograms() {
+    if (geometryProgram) glDeleteProgram(geometryProgram);
+    geometryProgram = 0;
+    for (int i = 0; i < 2; i++) {
+        if (directionalPrograms[i]) glDeleteProgram(directionalPrograms[i]);
+        if (lightPrograms[i]) glDeleteProgram(lightPrograms[i]);
+        directionalPrograms[i] = lightPrograms[i] = 0;
+    }
+}
+
+// Esfera unitária em latitude/longitude, triângulos com a face da frente para fora
+void DeferredRenderer::CreateSphere() {
+    const int rings = 12, segments = 16;
+    std::vector<glm::vec3> ring;
+    for (int r = 0; r <= rings; r++) {
+        float phi = glm::pi<float>() * r / rings;
+        for (int s = 0; s <= segments; s++) {
+            float theta = glm::two_pi<float>() * s / segments;
+            ring.push_back(glm::vec3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta)));
+        }
+    }
+
+    std::vector<glm::vec3> vertices;
+    for (int r = 0; r < rings; r++) {
+        for (int s = 0; s < segments; s++) {
+            int a = r * (segments + 1) + s;
+            int b = a + segments + 1;
+            vertices.push_back(ring[a]); vertices.push_back(ring[a + 1]); vertices.push_back(ring[b]);
+            vertices.push_back(ring[b]); vertices.push_back(ring[a + 1]); vertices.push_back(ring[b + 1]);
+        }
+    }
+    // o polígono inscrito fica dentro da esfera: aumenta um pouco para cobrir o alcance todo
+    for (auto& v : vertices) v = v * 1.1f;
+    sphereVertexCount = static_cast<GLsizei>(vertices.size());
+
+    glGenVertexArrays(1, &sphereVao);
+    glGenBuffers(1, &sphereVbo);
+    glBindVertexArray(sphereVao);
+    glBindBuffer(GL_ARRAY_BUFFER, sphereVbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (GLvoid*)0);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+}
+
+void DeferredRenderer::BeginGeometry(const FrameSnapshot& snapshot) {
+    TRACE_SCOPE("DeferredGeometry");
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, width, height);
+    // alpha do alvo 0 é flag (emissivo), não pode passar pelo blend
+    glDisable(GL_BLEND);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glUseProgram(geometryProgram);
+    glUniformMatrix4fv(glGetUniformLocation(geometryProgram, "view"), 1, GL_FALSE, glm::value_ptr(snapshot.view));
+    glUniformMatrix4fv(glGetUniformLocation(geometryProgram, "projection"), 1, GL_FALSE,
+            glm::value_ptr(snapshot.projection));
+}
+
+void DeferredRenderer::BindGBufferTextures(GLuint program) {
+    static const char* names[4] = {"gAlbedo", "gNormal", "gDiffuse", "gSpecular"};
+    for (int i = 0; i < 4; i++) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, targets[i]);
+        glUniform1i(glGetUniformLocation(program, names[i]), i);
+    }
+    glActiveTexture(GL_TEXTURE4);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glUniform1i(glGetUniformLocation(program, "gDepth"), 4);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void DeferredRenderer::Resolve(const FrameSnapshot& snapshot, const ShadowMaps& shadows) {
+    TRACE_SCOPE("DeferredLighting");
+    glm::mat4 viewProjection = snapshot.projection * snapshot.view;
+    glm::mat4 invViewProjection = glm::inverse(viewProjection);
+    GLuint directionalProgram = directionalPrograms[snapshot.shadows ? 1 : 0];
+    GLuint lightProgram = lightPrograms[snapshot.shadows ? 1 : 0];
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    glDisable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+
+    // direcional + ambiente, e pixels emissivos copiados direto
+    shadows.Bind(directionalProgram);
+    BindGBufferTextures(directionalProgram);
+    glUniformMatrix4fv(glGetUniformLocation(directionalProgram, "invViewProjection"), 1, GL_FALSE,
+            glm::value_ptr(invViewProjection));
+    SetVec3(directionalProgram, "viewPos", snapshot.viewPos);
+    SetVec3(directionalProgram, "dirLight.direction", snapshot.dirLight.direction);
+    SetVec3(directionalProgram, "dirLight.ambient", snapshot.dirLight.ambient);
+    SetVec3(directionalProgram, "dirLight.diffuse", snapshot.dirLight.diffuse);
+    SetVec3(directionalProgram, "dirLight.specular", snapshot.dirLight.specular);
+    glBindVertexArray(fullscreenVao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    // point/spot lights somadas; só as faces de trás do volume, para funcionar com a câmera dentro dele
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_FRONT);
+
+    shadows.Bind(lightProgram);
+    BindGBufferTextures(lightProgram);
+    glUniformMatrix4fv(glGetUniformLocation(lightProgram, "viewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+    glUniformMatrix4fv(glGetUniformLocation(lightProgram, "invViewProjection"), 1, GL_FALSE,
+            glm::value_ptr(invViewProjection));
+    glUniform2f(glGetUniformLocation(lightProgram, "screenSize"), static_cast<float>(width), static_cast<float>(height));
+    SetVec3(lightProgram, "viewPos", snapshot.viewPos);
+    glBindVertexArray(sphereVao);
+
+    glUniform1i(glGetUniformLocation(lightProgram, "isSpot"), 0);
+    for (const auto& light : snapshot.pointLights) {
+        SetVec3(lightProgram, "lightPosition", light.position);
+        SetVec3(lightProgram, "lightColor", light.color);
+        SetFloat(lightProgram, "constant", light.constant);
+        SetFloat(lightProgram, "linear", light.linear);
+        SetFloat(lightProgram, "quadratic", light.quadratic);
+        SetVec3(lightProgram, "lightAmbient", light.ambient);
+        SetVec3(lightProgram, "lightDiffuse", light.diffuse);
+        SetVec3(lightProgram, "lightSpecular", light.specular);
+        DrawLightVolume(lightProgram, light.position, LightRadius(light.color, light.constant, light.linear, light.quadratic));
+    }
+
+    glUniform1i(glGetUniformLocation(lightProgram, "isSpot"), 1);
+    for (size_t i = 0; i < snapshot.spotLights.size(); i++) {
+        const SpotLight& light = snapshot.spotLights[i];
+        glUniform1i(glGetUniformLocation(lightProgram, "shadowLayer"), shadows.SpotLayer(i));
+        SetVec3(lightProgram, "lightPosition", light.position);
+        SetVec3(lightProgram, "lightDirection", light.direction);
+        SetVec3(lightProgram, "lightColor", light.color);
+        SetFloat(lightProgram, "cutOff", light.cutOff);
+        SetFloat(lightProgram, "outerCutOff", light.outerCutOff);
+        SetFloat(lightProgram, "constant", light.constant);
+        SetFloat(lightProgram, "linear", light.linear);
+        SetFloat(lightProgram, "quadratic", light.quadratic);
+        SetVec3(lightProgram, "lightAmbient", light.ambient);
+        SetVec3(lightProgram, "lightDiffuse", light.diffuse);
+        SetVec3(lightProgram, "lightSpecular", light.specular);
+        DrawLightVolume(lightProgram, light.position, LightRadius(light.color, light.constant, light.linear, light.quadratic));
+    }
+
+    glDisable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_TRUE);
+    glBindVertexArray(0);
+
+    // profundidade da cena no framebuffer padrão: o céu só desenha onde não há geometria
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void DeferredRenderer::DrawLightVolume(GLuint lightProgram, const glm::vec3& center, float radius) {
+    if (radius <= 0.0f)
+        return;
+    SetVec3(lightProgram, "lightCenter", center);
+    SetFloat(lightProgram, "lightRadius", radius);
+    glDrawArrays(GL_TRIANGLES, 0, sphereVertexCount);
+}
+
+DeferredRenderer::~DeferredRenderer() {
+    Destroy();
+}
+
+void DeferredRenderer::Destroy() {
+    if (fbo) glDeleteFramebuffers(1, &fbo);
+    if (targets[0]) glDeleteTextures(4, targets);
+    if (depthTexture) glDeleteTextures(1, &depthTexture);
+    if (fullscreenVao) glDeleteVertexArrays(1, &fullscreenVao);
+    if (sphereVao) glDeleteVertexArrays(1, &sphereVao);
+    if (sphereVbo) glDeleteBuffers(1, &sphereVbo);
+    DeletePrograms();
+
+    fbo = depthTexture = fullscreenVao = sphereVao = sphereVbo = 0;
+    for (auto& target : targets) target = 0;
+}
@@ -0,0 +1,54 @@
+// DeferredRenderer.h
+#ifndef DEFERRED_RENDERER_H
+#define DEFERRED_RENDERER_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include "FrameSnapshot.h"
+#include "ShadowMaps.h"
+
+// Caminho deferred: a geometria grava material e normal num G-buffer uma vez, e cada
+// point/spot light só sombreia os pixels cobertos pelo seu volume (esfera do alcance).
+// Custo ~ pixels + pixels cobertos por luz, em vez de fragmentos × luzes do forward.
+//   deferred.BeginGeometry(snapshot);
+//   obj->Draw(deferred.GeometryProgram(), ...);
+//   deferred.Resolve(snapshot, shadows);   // ilumina no framebuffer padrão e copia a profundidade
+class DeferredRenderer {
+public:
+    DeferredRenderer() = default;
+    ~DeferredRenderer();
+    DeferredRenderer(const DeferredRenderer&) = delete;
+    DeferredRenderer& operator=(const DeferredRenderer&) = delete;
+
+    // Compila os programas e cria o G-buffer no tamanho do framebuffer da janela
+    void Initialize(int width, int height);
+    void Destroy();
+    // Compila os programas; no hot reload só troca se todos compilarem (senão lança e mantém os atuais)
+    void BuildPrograms();
+
+    GLuint GeometryProgram() const { return geometryProgram; }
+
+    void BeginGeometry(const FrameSnapshot& snapshot);
+    void Resolve(const FrameSnapshot& snapshot, const ShadowMaps& shadows);
+
+private:
+    int width{0}, height{0};
+    GLuint fbo{0};
+    GLuint targets[4]{0, 0, 0, 0};  // albedo, normal+shininess, diffuse, specular
+    GLuint depthTexture{0};
+
+    GLuint geometryProgram{0};
+    GLuint directionalPrograms[2]{0, 0};  // índice: sombras ligadas
+    GLuint lightPrograms[2]{0, 0};
+
+    GLuint fullscreenVao{0};
+    GLuint sphereVao{0}, sphereVbo{0};
+    GLsizei sphereVertexCount{0};
+
+    void DeletePrograms();
+    void CreateSphere();
+    void BindGBufferTextures(GLuint program);
+    void DrawLightVolume(GLuint lightProgram, const glm::vec3& center, float radius);
+};
+
+#endif
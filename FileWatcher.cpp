@@ -0,0 +1,95 @@
+// FileWatcher.cpp
+#include "FileWatcher.h"
+#include <iostream>
+#include <set>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include "Tracer.h"
+
+namespace {
+
+const int kQuietMs = 50;  // espera por mais eventos antes de avisar
+
+} // namespace
+
+FileWatcher::~FileWatcher() {
+    Stop();
+}
+
+bool FileWatcher::Start(const std::vector<std::string>& directories, std::function<void(const std::string&)> onChange) {
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "inotify unavailable; hot reload disabled" << std::endl;
+        return false;
+    }
+    if (pipe(stopPipe) != 0) {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    // fechar depois de gravar ou chegar por rename cobre os editores comuns
+    for (const auto& directory : directories) {
+        int wd = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd < 0) {
+            std::cerr << "Cannot watch " << directory << std::endl;
+            continue;
+        }
+        watches[wd] = directory;
+    }
+
+    this->onChange = onChange;
+    thread = std::thread(&FileWatcher::Run, this);
+    return true;
+}
+
+void FileWatcher::Run() {
+    Tracer::SetThreadName("file watcher");
+    std::set<std::string> changed;
+    alignas(inotify_event) char buffer[4096];
+
+    while (true) {
+        pollfd fds[2] = {{fd, POLLIN, 0}, {stopPipe[0], POLLIN, 0}};
+        int ready = poll(fds, 2, changed.empty() ? -1 : kQuietMs);
+        if (ready < 0)
+            continue;
+        if (fds[1].revents & POLLIN)
+            break;
+
+        if (ready == 0) {
+            // silêncio depois de uma rajada: entrega cada arquivo uma vez
+            for (const auto& path : changed) {
+                onChange(path);
+            }
+            changed.clear();
+            continue;
+        }
+
+        ssize_t length;
+        while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + length;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                if (event->len > 0 && watches.count(event->wd)) {
+                    const std::string& directory = watches[event->wd];
+                    changed.insert(directory == "." ? std::string(event->name) : directory + "/" + event->name);
+                }
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+}
+
+void FileWatcher::Stop() {
+    if (thread.joinable()) {
+        char stop = 1;
+        if (write(stopPipe[1], &stop, 1) != 1)
+            std::cerr << "Cannot stop file watcher" << std::endl;
+        thread.join();
+    }
+    if (fd >= 0) close(fd);
+    if (stopPipe[0] >= 0) close(stopPipe[0]);
+    if (stopPipe[1] >= 0) close(stopPipe[1]);
+    fd = stopPipe[0] = stopPipe[1] = -1;
+    watches.clear();
+}
@@ -0,0 +1,34 @@
+// FileWatcher.h
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Observa diretórios com inotify (sem recursão) numa thread própria. Eventos do mesmo arquivo
+// que chegam juntos (editores gravam em várias etapas) viram uma única chamada do callback,
+// que roda na thread do watcher com o caminho "diretório/nome".
+class FileWatcher {
+public:
+    FileWatcher() = default;
+    ~FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    bool Start(const std::vector<std::string>& directories, std::function<void(const std::string&)> onChange);
+    void Stop();
+
+private:
+    int fd{-1};
+    int stopPipe[2]{-1, -1};
+    std::map<int, std::string> watches;  // descritor -> diretório
+    std::function<void(const std::string&)> onChange;
+    std::thread thread;
+
+    void Run();
+};
+
+#endif
@@ -0,0 +1,129 @@
+// FloatParser.cpp
+#include "FloatParser.h"
+#include <cfloat>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Potências de 10 exatas em double (até 10^22)
+const double kPowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+const uint64_t kIntegerPowersOfTen[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull
+};
+
+// Quantos dígitos seguidos começam em text (até 16)
+inline int DigitRun(const char* text) {
+#if defined(__SSE2__)
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text));
+    // c - '0' sem sinal <= 9  <=>  min(c - '0', 9) == c - '0'
+    __m128i shifted = _mm_sub_epi8(chunk, _mm_set1_epi8('0'));
+    __m128i digits = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(9)), shifted);
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(digits));
+    return __builtin_ctz(~mask);  // o bit 16 de ~mask está sempre ligado
+#else
+    int count = 0;
+    while (count < 16 && text[count] >= '0' && text[count] <= '9')
+        count++;
+    return count;
+#endif
+}
+
+// Valor de count (1-8) dígitos: o bloco é deslocado para que os bytes de fora virem zeros à esquerda,
+// e cada passo junta pares vizinhos (1+1 -> 2 dígitos, 2+2 -> 4, 4+4 -> 8)
+inline uint64_t EightDigits(const char* text, int count) {
+    uint64_t chunk;
+    memcpy(&chunk, text, sizeof(chunk));
+    chunk <<= 8 * (8 - count);
+    chunk = (chunk & 0x0F0F0F0F0F0F0F0Full) * 2561 >> 8;
+    chunk = (chunk & 0x00FF00FF00FF00FFull) * 6553601 >> 16;
+    return (chunk & 0x0000FFFF0000FFFFull) * 42949672960001ull >> 32;
+}
+
+inline uint64_t Digits(const char* text, int count) {
+    if (count == 0)
+        return 0;
+    if (count <= 8)
+        return EightDigits(text, count);
+    return EightDigits(text, 8) * kIntegerPowersOfTen[count - 8] + EightDigits(text + 8, count - 8);
+}
+
+const char* Fallback(const char* text, float& value) {
+    char* end;
+    value = strtof(text, &end);
+    return end;
+}
+
+} // namespace
+
+const char* ParseFloat(const char* text, float& value) {
+    const char* p = text;
+    bool negative = *p == '-';
+    if (*p == '-' || *p == '+')
+        p++;
+
+    int integerDigits = DigitRun(p);
+    if (integerDigits > 8)
+        return Fallback(text, value);  // 9+ dígitos antes do ponto: raro em .obj (16 pode ser mais)
+    uint64_t mantissa = Digits(p, integerDigits);
+    p += integerDigits;
+
+    int fractionDigits = 0;
+    if (*p == '.') {
+        p++;
+        fractionDigits = DigitRun(p);
+        if (integerDigits + fractionDigits > 19 || fractionDigits >= 16)
+            return Fallback(text, value);
+        mantissa = mantissa * (fractionDigits > 8 ? kIntegerPowersOfTen[8] * kIntegerPowersOfTen[fractionDigits - 8]
+                                                  : kIntegerPowersOfTen[fractionDigits]) +
+                   Digits(p, fractionDigits);
+        p += fractionDigits;
+    }
+    if (integerDigits + fractionDigits == 0)
+        return Fallback(text, value);
+
+    int exponent = -fractionDigits;
+    if (*p == 'e' || *p == 'E') {
+        const char* q = p + 1;
+        bool negativeExponent = *q == '-';
+        if (*q == '-' || *q == '+')
+            q++;
+        int exponentDigits = DigitRun(q);
+        if (exponentDigits == 0 || exponentDigits > 3)
+            return Fallback(text, value);
+        int explicitExponent = static_cast<int>(Digits(q, exponentDigits));
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+        p = q + exponentDigits;
+    }
+
+    if (mantissa == 0) {
+        value = negative ? -0.0f : 0.0f;
+        return p;
+    }
+    if ((mantissa >> 53) != 0 || exponent < -22 || exponent > 22)
+        return Fallback(text, value);
+
+    // uma operação IEEE com operandos exatos: o double é o arredondamento correto do decimal
+    double exact = exponent < 0 ? static_cast<double>(mantissa) / kPowersOfTen[-exponent]
+                                : static_cast<double>(mantissa) * kPowersOfTen[exponent];
+    if (exact > FLT_MAX || exact < FLT_MIN)
+        return Fallback(text, value);
+    // double -> float só erra se o double cair exatamente no meio de dois floats
+    // (29 bits de baixo = 1000...0); aí quem desempata é o strtof
+    uint64_t bits;
+    memcpy(&bits, &exact, sizeof(bits));
+    if ((bits & 0x1FFFFFFFull) == 0x10000000ull)
+        return Fallback(text, value);
+
+    float result = static_cast<float>(exact);
+    value = negative ? -result : result;
+    return p;
+}
@@ -0,0 +1,18 @@
+// FloatParser.h
+#ifndef FLOAT_PARSER_H
+#define FLOAT_PARSER_H
+
+#include <cstddef>
+
+// Número decimal -> float direto do texto em memória, para os .obj.
+// Caminho rápido: os dígitos são classificados 16 bytes por vez (SSE2), convertidos 8 por vez com
+// aritmética inteira, e a mantissa decimal vira float com uma única multiplicação/divisão exata em
+// double (Clinger: mantissa < 2^53 e |expoente| <= 22). Resultado arredondado corretamente, igual
+// ao strtof; o que foge do caminho rápido (mais de 19 dígitos, inf/nan, hexa...) usa o próprio strtof.
+// Não pula espaços antes do número. O texto precisa de kParsePadding bytes legíveis depois do '\0'.
+const size_t kParsePadding = 16;
+
+// Retorna o fim do número (ou text, se não havia número, com value = 0)
+const char* ParseFloat(const char* text, float& value);
+
+#endif
@@ -0,0 +1,136 @@
+// FrameSnapshot.h
+#ifndef FRAME_SNAPSHOT_H
+#define FRAME_SNAPSHOT_H
+
+#include <glm/glm.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "Object.h"
+
+// Estruturas de Luz
+struct DirLight {
+    glm::vec3 direction;
+    glm::vec3 ambient;
+    glm::vec3 diffuse;
+    glm::vec3 specular;
+};
+
+struct PointLight {
+    glm::vec3 position;
+    glm::vec3 color;
+    float constant;
+    float linear;
+    float quadratic;
+    glm::vec3 ambient;
+    glm::vec3 diffuse;
+    glm::vec3 specular;
+};
+
+struct SpotLight {
+    glm::vec3 position;
+    glm::vec3 direction;
+    glm::vec3 color;
+
+    float cutOff;
+    float outerCutOff;
+
+    float constant;
+    float linear;
+    float quadratic;
+
+    glm::vec3 ambient;
+    glm::vec3 diffuse;
+    glm::vec3 specular;
+
+    // material de origem: identifica a luz entre frames (shadow map em cache)
+    const Object* owner{nullptr};
+    size_t material{0};
+};
+
+// Estado de um objeto congelado para um frame; o Object só é usado pelos seus recursos GL
+struct ObjectDrawState {
+    Object* object;
+    glm::mat4 model;
+    std::vector<MaterialProperties> materials;
+    glm::vec3 boundsMin, boundsMax;  // AABB no mundo
+    float distance;                  // da câmera até a AABB (0 se dentro)
+    unsigned revision;               // Object::Revision() no momento do snapshot
+    size_t lod;                      // nível de detalhe (Object::SelectLod), o mesmo em todos os passes da câmera
+    bool impostor;                   // desenhado por Impostors em vez do mesh (sombras continuam com o mesh)
+    bool occluded;                   // escondido pelos oclusores da cena (SoftwareOcclusion, na simulação)
+};
+
+// Tudo que a renderização de um frame precisa, produzido pela simulação
+struct FrameSnapshot {
+    glm::mat4 view{1.0f};
+    glm::mat4 projection{1.0f};
+    glm::vec3 viewPos{0.0f};
+    bool polygonMode{false};
+    bool depthPrepass{true};
+    bool deferred{false};
+    bool shadows{true};
+    bool occlusion{true};            // teste Hi-Z na thread de render (o da CPU já vem em ObjectDrawState::occluded)
+
+    DirLight dirLight;
+    std::vector<PointLight> pointLights;
+    std::vector<SpotLight> spotLights;
+    std::vector<ObjectDrawState> objects;  // ordenados da frente para trás
+
+    float skyRotation{0.0f};
+    glm::vec3 skyTint{1.0f};
+};
+
+// Double buffer de snapshots entre a thread de simulação e a de renderização.
+// A simulação escreve um slot enquanto o render consome o outro; no máximo um frame de diferença.
+class SnapshotExchange {
+public:
+    // Slot que a simulação pode escrever (nunca é o que o render está lendo)
+    FrameSnapshot& WriteSlot() { return slots[writeIndex]; }
+
+    // Entrega o slot escrito e espera o outro slot ficar livre para o próximo frame
+    void Publish() {
+        std::unique_lock<std::mutex> lock(mutex);
+        pendingIndex = writeIndex;
+        changed.notify_all();
+
+        int next = 1 - writeIndex;
+        changed.wait(lock, [&] { return closed || (readingIndex != next && pendingIndex != next); });
+        writeIndex = next;
+    }
+
+    // Render: espera um snapshot novo; nullptr quando fechado
+    const FrameSnapshot* Acquire() {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return closed || pendingIndex >= 0; });
+        if (pendingIndex < 0)
+            return nullptr;
+
+        readingIndex = pendingIndex;
+        pendingIndex = -1;
+        return &slots[readingIndex];
+    }
+
+    void Release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        readingIndex = -1;
+        changed.notify_all();
+    }
+
+    void Close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        changed.notify_all();
+    }
+
+private:
+    FrameSnapshot slots[2];
+    int writeIndex{0};
+    int pendingIndex{-1};
+    int readingIndex{-1};
+    bool closed{false};
+    std::mutex mutex;
+    std::condition_variable changed;
+};
+
+#endif
@@ -0,0 +1,87 @@
+// FrameTimer.cpp
+#include "FrameTimer.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "Tracer.h"
+
+// Evita que uma trava longa (carregamento, janela arrastada) vire um salto enorme na simulação
+static const double kMaxDeltaTime = 0.1;
+static const int kMaxFixedSteps = 8;
+// Parte final da espera feita em spin, já que sleep_for costuma acordar atrasado
+static const double kSpinWindow = 0.0005;
+
+FrameTimer::FrameTimer(const FrameTimingConfig& config)
+    : config(config)
+    , fixedStep(config.fixedStepHz > 0.0 ? 1.0 / config.fixedStepHz : 0.0)
+    , lastTime(0.0)
+    , nextDeadline(0.0)
+    , deltaTime(0.0)
+    , accumulator(0.0)
+    , averageFrameMs(0.0)
+{
+}
+
+void FrameTimer::ApplySwapInterval() const {
+    int interval = config.swapInterval;
+    if (interval < 0 && !glfwExtensionSupported("GLX_EXT_swap_control_tear") &&
+        !glfwExtensionSupported("WGL_EXT_swap_control_tear")) {
+        interval = 1;
+    }
+    glfwSwapInterval(interval);
+}
+
+void FrameTimer::Reset() {
+    lastTime = nextDeadline = glfwGetTime();
+    accumulator = 0.0;
+}
+
+float FrameTimer::BeginFrame() {
+    double now = glfwGetTime();
+    deltaTime = std::min(now - lastTime, kMaxDeltaTime);
+    lastTime = now;
+
+    // média móvel exponencial, só para relatório
+    averageFrameMs = averageFrameMs == 0.0 ? deltaTime * 1000.0
+                                           : averageFrameMs * 0.95 + deltaTime * 1000.0 * 0.05;
+
+    if (UsesFixedStep())
+        accumulator += deltaTime;
+    return static_cast<float>(deltaTime);
+}
+
+int FrameTimer::ConsumeFixedSteps() {
+    if (!UsesFixedStep())
+        return 0;
+
+    int steps = 0;
+    while (accumulator >= fixedStep && steps < kMaxFixedSteps) {
+        accumulator -= fixedStep;
+        steps++;
+    }
+    // se ficou para trás demais, descarta o resto em vez de entrar em espiral
+    if (steps == kMaxFixedSteps)
+        accumulator = 0.0;
+    return steps;
+}
+
+void FrameTimer::LimitFrameRate() {
+    if (config.fpsCap <= 0.0)
+        return;
+
+    TRACE_SCOPE("LimitFrameRate");
+    double period = 1.0 / config.fpsCap;
+    double now = glfwGetTime();
+    nextDeadline += period;
+    if (nextDeadline < now)
+        nextDeadline = now;
+
+    double remaining = nextDeadline - now;
+    if (remaining > kSpinWindow) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(remaining - kSpinWindow));
+    }
+    while (glfwGetTime() < nextDeadline) {
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,38 @@
+// FrameTimer.h
+#ifndef FRAME_TIMER_H
+#define FRAME_TIMER_H
+
+struct FrameTimingConfig {
+    int swapInterval{1};     // 0 = sem vsync, 1 = vsync, -1 = vsync adaptativo (se suportado)
+    double fpsCap{0.0};      // limite de FPS feito com sleep; 0 = sem limite
+    double fixedStepHz{0.0}; // frequência da simulação em passo fixo; 0 = usa o delta time do frame
+};
+
+// Mede o tempo entre frames, aplica o modo de vsync e limita a taxa de frames.
+// Em modo de passo fixo, acumula o tempo do frame e devolve quantos passos simular.
+class FrameTimer {
+public:
+    explicit FrameTimer(const FrameTimingConfig& config);
+
+    void ApplySwapInterval() const;   // precisa de contexto GL atual
+    void Reset();                     // chamar logo antes do loop principal
+    float BeginFrame();               // retorna o delta time (segundos) do frame
+    int ConsumeFixedSteps();          // passos de simulação para este frame (0 se desligado)
+    void LimitFrameRate();            // dorme até o prazo do próximo frame
+
+    bool UsesFixedStep() const { return fixedStep > 0.0; }
+    float FixedStep() const { return static_cast<float>(fixedStep); }
+    float DeltaTime() const { return static_cast<float>(deltaTime); }
+    double AverageFrameMs() const { return averageFrameMs; }
+
+private:
+    FrameTimingConfig config;
+    double fixedStep;
+    double lastTime;
+    double nextDeadline;
+    double deltaTime;
+    double accumulator;
+    double averageFrameMs;
+};
+
+#endif
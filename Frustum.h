@@ -0,0 +1,25 @@
+// Frustum.h
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+// Descarta a AABB só se os 8 cantos estão do lado de fora do mesmo plano de recorte
+inline bool BoxInFrustum(const glm::mat4& viewProjection, const glm::vec3& lo, const glm::vec3& hi) {
+    int outside[6] = {0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < 8; i++) {
+        glm::vec4 p = viewProjection * glm::vec4((i & 1) ? hi.x : lo.x, (i & 2) ? hi.y : lo.y, (i & 4) ? hi.z : lo.z, 1.0f);
+        if (p.x < -p.w) outside[0]++;
+        if (p.x > p.w) outside[1]++;
+        if (p.y < -p.w) outside[2]++;
+        if (p.y > p.w) outside[3]++;
+        if (p.z < -p.w) outside[4]++;
+        if (p.z > p.w) outside[5]++;
+    }
+    for (int count : outside) {
+        if (count == 8) return false;
+    }
+    return true;
+}
+
+#endif
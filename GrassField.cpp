@@ -0,0 +1,279 @@
+// GrassField.cpp
+#include "GrassField.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Frustum.h"
+#include "Shader.h"
+#include "Tracer.h"
+
+namespace {
+
+const float kPi = 3.14159265f;
+const float kCellSize = 16.0f;  // também o tamanho do ladrilho de blue noise
+// Distância mínima entre tufos de cada nível (× spacing): cada nível completa os anteriores
+const float kLevelRadius[GrassField::kLevels] = {2.0f, 1.41f, 1.0f};
+// O nível i só aparece em células mais perto que isso; a densidade cai 1/2 a cada nível a menos
+const float kLevelDistance[GrassField::kLevels] = {100.0f, 50.0f, 25.0f};
+const int kBlades = 7;
+const int kCandidates = 30;  // tentativas por ponto ativo (Bridson)
+
+// Sequências iguais em qualquer biblioteca padrão (std::uniform_real_distribution não garante)
+struct Random {
+    uint32_t state;
+    float Next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (state >> 8) * (1.0f / 16777216.0f);
+    }
+};
+
+// Valor em [0, 1) fixo para cada (x, y, canal), sem guardar estado
+float Hash(uint32_t x, uint32_t y, uint32_t channel) {
+    uint32_t h = x * 0x8da6b343u ^ y * 0xd8163841u ^ channel * 0xcb1ab31fu;
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return (h >> 8) * (1.0f / 16777216.0f);
+}
+
+glm::vec2 Wrap(glm::vec2 p) {
+    return p - glm::vec2(std::floor(p.x / kCellSize), std::floor(p.y / kCellSize)) * kCellSize;
+}
+
+// Poisson disk hierárquico num ladrilho toroidal: repetido lado a lado continua sem emendas,
+// e qualquer prefixo de níveis (0, 0-1, 0-2) também é blue noise, só mais esparso
+std::vector<glm::vec2> PoissonTile(float spacing, size_t levelEnd[GrassField::kLevels]) {
+    std::vector<glm::vec2> points;
+    Random random{0x9e3779b9u};
+
+    for (int level = 0; level < GrassField::kLevels; level++) {
+        float radius = spacing * kLevelRadius[level];
+        auto fits = [&](const glm::vec2& candidate) {
+            for (const glm::vec2& point : points) {
+                glm::vec2 d = glm::abs(candidate - point);
+                d = glm::min(d, glm::vec2(kCellSize) - d);
+                if (d.x * d.x + d.y * d.y < radius * radius)
+                    return false;
+            }
+            return true;
+        };
+
+        std::vector<size_t> active;
+        for (size_t i = 0; i < points.size(); i++) {
+            active.push_back(i);
+        }
+        if (points.empty()) {
+            points.push_back(glm::vec2(random.Next(), random.Next()) * kCellSize);
+            active.push_back(0);
+        }
+
+        while (!active.empty()) {
+            size_t slot = static_cast<size_t>(random.Next() * active.size());
+            glm::vec2 origin = points[active[slot]];
+            bool placed = false;
+            for (int attempt = 0; attempt < kCandidates && !placed; attempt++) {
+                float angle = random.Next() * 2.0f * kPi;
+                float distance = radius * (1.0f + random.Next());
+                glm::vec2 candidate = Wrap(origin + glm::vec2(std::cos(angle), std::sin(angle)) * distance);
+                if (fits(candidate)) {
+                    active.push_back(points.size());
+                    points.push_back(candidate);
+                    placed = true;
+                }
+            }
+            if (!placed) {
+                active[slot] = active.back();
+                active.pop_back();
+            }
+        }
+        levelEnd[level] = points.size();
+    }
+    return points;
+}
+
+// fs.glsl (com shadow.glsl) ou gbuffer_fs.glsl lendo a cor por instância de grass_vs.glsl
+std::string TintedFragment(bool forward) {
+    std::string source = forward ? InsertAfterVersion(loadShaderFromFile("fs.glsl"), loadShaderFromFile("shadow.glsl"))
+                                 : loadShaderFromFile("gbuffer_fs.glsl");
+    return InsertAfterVersion(source, "#define INSTANCE_TINT");
+}
+
+} // namespace
+
+void GrassField::Initialize(const SceneGrass& settings, const MaterialProperties& material, GLuint texture) {
+    TRACE_SCOPE("GrassField::Initialize");
+    this->material = material;
+    this->texture = texture;
+
+    std::vector<Instance> instances;
+    Scatter(settings, instances);
+    CreateTuft(settings.bladeHeight);
+
+    glBindVertexArray(vao);
+    glGenBuffers(1, &instanceVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(Instance), instances.data(), GL_STATIC_DRAW);
+    // o ponteiro muda por célula em Draw (sem base instance no GL 3.3)
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+    glEnableVertexAttribArray(4);
+    glVertexAttribDivisor(4, 1);
+    glBindVertexArray(0);
+
+    std::string vertex = loadShaderFromFile("grass_vs.glsl");
+    forwardShaders.Initialize(vertex, TintedFragment(true));
+    geometryProgram = CreateProgram(vertex, TintedFragment(false));
+}
+
+void GrassField::ReloadPrograms() {
+    if (!Enabled())
+        return;
+    std::string vertex = loadShaderFromFile("grass_vs.glsl");
+    GLuint geometry = CreateProgram(vertex, TintedFragment(false));
+    try {
+        forwardShaders.Reload(vertex, TintedFragment(true));
+    } catch (...) {
+        glDeleteProgram(geometry);
+        throw;
+    }
+    if (geometryProgram) glDeleteProgram(geometryProgram);
+    geometryProgram = geometry;
+}
+
+void GrassField::Scatter(const SceneGrass& settings, std::vector<Instance>& instances) {
+    size_t tileLevelEnd[kLevels];
+    std::vector<glm::vec2> tile = PoissonTile(settings.spacing, tileLevelEnd);
+
+    int cellsPerSide = static_cast<int>(std::ceil(2.0f * settings.radius / kCellSize));
+    float radiusSquared = settings.radius * settings.radius;
+    for (int cz = 0; cz < cellsPerSide; cz++) {
+        for (int cx = 0; cx < cellsPerSide; cx++) {
+            glm::vec2 origin = glm::vec2(cx, cz) * kCellSize - glm::vec2(settings.radius);
+            Cell cell;
+            cell.first = instances.size();
+            cell.boundsMin = glm::vec3(origin.x, settings.height, origin.y);
+            cell.boundsMax = glm::vec3(origin.x + kCellSize, settings.height + settings.bladeHeight * 1.3f, origin.y + kCellSize);
+
+            size_t point = 0;
+            for (int level = 0; level < kLevels; level++) {
+                for (; point < tileLevelEnd[level]; point++) {
+                    glm::vec2 position = origin + tile[point];
+                    if (position.x * position.x + position.y * position.y > radiusSquared)
+                        continue;
+                    // atributos pela posição no mundo: a repetição do ladrilho não se repete neles
+                    uint32_t cellIndex = static_cast<uint32_t>(cz * cellsPerSide + cx);
+                    uint32_t pointIndex = static_cast<uint32_t>(point);
+                    float angle = Hash(cellIndex, pointIndex, 0) * 2.0f * kPi;
+                    float scale = 0.7f + 0.6f * Hash(cellIndex, pointIndex, 1);
+                    float dry = Hash(cellIndex, pointIndex, 2);
+                    glm::vec3 tint = glm::vec3(0.85f, 1.0f, 0.8f) + glm::vec3(0.3f, 0.05f, -0.1f) * dry;
+                    instances.push_back({glm::vec4(position.x, settings.height, position.y, angle),
+                                         glm::vec4(scale, tint.x, tint.y, tint.z)});
+                }
+                cell.levelEnd[level] = instances.size() - cell.first;
+            }
+            if (cell.levelEnd[kLevels - 1] > 0)
+                cells.push_back(cell);
+        }
+    }
+}
+
+// Tufo de lâminas triangulares em volta da base, cada uma com uma faixa diferente da textura
+void GrassField::CreateTuft(float bladeHeight) {
+    struct TuftVertex {
+        glm::vec3 position;
+        glm::vec2 texture_coord;
+    };
+    std::vector<TuftVertex> vertices;
+    for (int blade = 0; blade < kBlades; blade++) {
+        float angle = blade * 2.39996f;  // ângulo áureo: lâminas espalhadas sem padrão
+        glm::vec3 out(std::cos(angle), 0.0f, std::sin(angle));
+        glm::vec3 side(-out.z, 0.0f, out.x);
+        glm::vec3 base = out * (0.04f * (blade % 3));
+        float height = bladeHeight * (0.7f + 0.3f * ((blade * 5) % 7) / 6.0f);
+        glm::vec3 tip = base + out * (0.25f * bladeHeight) + glm::vec3(0.0f, height, 0.0f);
+        float u = blade / static_cast<float>(kBlades);
+
+        vertices.push_back({base - side * 0.05f, glm::vec2(u, 0.0f)});
+        vertices.push_back({base + side * 0.05f, glm::vec2(u + 0.1f, 0.0f)});
+        vertices.push_back({tip, glm::vec2(u + 0.05f, 1.0f)});
+    }
+    tuftVertexCount = static_cast<GLsizei>(vertices.size());
+
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glGenBuffers(1, &tuftVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, tuftVbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(TuftVertex), vertices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(TuftVertex), (void*)offsetof(TuftVertex, position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(TuftVertex), (void*)offsetof(TuftVertex, texture_coord));
+}
+
+size_t GrassField::Cull(const FrameSnapshot& snapshot) {
+    visible.clear();
+    if (!Enabled())
+        return 0;
+
+    TRACE_SCOPE("GrassCull");
+    glm::mat4 viewProjection = snapshot.projection * snapshot.view;
+    size_t total = 0;
+    for (const Cell& cell : cells) {
+        glm::vec3 closest = glm::clamp(snapshot.viewPos, cell.boundsMin, cell.boundsMax);
+        float distance = glm::length(closest - snapshot.viewPos);
+        int levels = 0;
+        while (levels < kLevels && distance < kLevelDistance[levels])
+            levels++;
+        if (levels == 0 || !BoxInFrustum(viewProjection, cell.boundsMin, cell.boundsMax))
+            continue;
+
+        size_t count = cell.levelEnd[levels - 1];
+        if (count > 0) {
+            visible.push_back(std::make_pair(cell.first, count));
+            total += count;
+        }
+    }
+    return total;
+}
+
+void GrassField::Draw(GLuint program, const FrameSnapshot& snapshot) const {
+    if (visible.empty())
+        return;
+
+    TRACE_SCOPE("GrassDraw");
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(snapshot.view));
+    glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, glm::value_ptr(snapshot.projection));
+    ApplyMaterial(program, material, texture);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    for (const auto& range : visible) {
+        size_t offset = range.first * sizeof(Instance);
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(offset + offsetof(Instance, positionAngle)));
+        glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(offset + offsetof(Instance, scaleTint)));
+        glDrawArraysInstanced(GL_TRIANGLES, 0, tuftVertexCount, static_cast<GLsizei>(range.second));
+    }
+    glBindVertexArray(0);
+}
+
+GrassField::~GrassField() {
+    Destroy();
+}
+
+void GrassField::Destroy() {
+    forwardShaders.Destroy();
+    if (geometryProgram) glDeleteProgram(geometryProgram);
+    if (vao) glDeleteVertexArrays(1, &vao);
+    if (tuftVbo) glDeleteBuffers(1, &tuftVbo);
+    if (instanceVbo) glDeleteBuffers(1, &instanceVbo);
+    geometryProgram = vao = tuftVbo = instanceVbo = 0;
+    cells.clear();
+    visible.clear();
+}
@@ -0,0 +1,70 @@
+// GrassField.h
+#ifndef GRASS_FIELD_H
+#define GRASS_FIELD_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <utility>
+#include <vector>
+#include "FrameSnapshot.h"
+#include "Scene.h"
+#include "ShaderVariants.h"
+
+// Grama instanciada sobre o chão: tufos espalhados na CPU com blue noise determinístico
+// (Poisson disk em ladrilho toroidal, repetido a cada célula), em células com AABB própria.
+// Cada célula guarda as instâncias ordenadas por nível de densidade; longe da câmera só o
+// prefixo dos níveis mais esparsos é desenhado, e células fora do frustum ou do alcance somem.
+//   grass.Initialize(settings, material, texture);   na carga
+//   grass.Cull(snapshot);                              uma vez por frame
+//   glUseProgram(p); grass.Draw(p, snapshot);          p = ForwardProgram(key) ou GeometryProgram()
+class GrassField {
+public:
+    static const int kLevels = 3;
+
+    GrassField() = default;
+    ~GrassField();
+    GrassField(const GrassField&) = delete;
+    GrassField& operator=(const GrassField&) = delete;
+
+    void Initialize(const SceneGrass& settings, const MaterialProperties& material, GLuint texture);
+    void Destroy();
+    void ReloadPrograms();  // hot reload; lança e mantém os atuais se falhar
+    bool Enabled() const { return vao != 0; }
+
+    // Retorna quantas instâncias o último Cull escolheu
+    size_t Cull(const FrameSnapshot& snapshot);
+    size_t TrianglesPerInstance() const { return tuftVertexCount / 3; }
+
+    const MaterialProperties& Material() const { return material; }
+    GLuint Texture() const { return texture; }
+    GLuint ForwardProgram(uint32_t key) { return forwardShaders.Get(key); }  // fs.glsl com INSTANCE_TINT
+    GLuint GeometryProgram() const { return geometryProgram; }               // gbuffer_fs.glsl com INSTANCE_TINT
+
+    void Draw(GLuint program, const FrameSnapshot& snapshot) const;
+
+private:
+    struct Instance {
+        glm::vec4 positionAngle;  // base no mundo, giro em Y
+        glm::vec4 scaleTint;      // escala, cor
+    };
+    struct Cell {
+        glm::vec3 boundsMin, boundsMax;
+        size_t first;
+        size_t levelEnd[kLevels];  // instâncias dos níveis 0..i: [first, first + levelEnd[i])
+    };
+
+    MaterialProperties material;
+    GLuint texture{0};  // pertence ao TextureCache
+    ShaderVariants forwardShaders;
+    GLuint geometryProgram{0};
+    GLuint vao{0}, tuftVbo{0}, instanceVbo{0};
+    GLsizei tuftVertexCount{0};
+
+    std::vector<Cell> cells;
+    std::vector<std::pair<size_t, size_t>> visible;  // (primeira instância, quantidade) do último Cull
+
+    void Scatter(const SceneGrass& settings, std::vector<Instance>& instances);
+    void CreateTuft(float bladeHeight);
+};
+
+#endif
@@ -0,0 +1,205 @@
+// HiZOcclusion.cpp
+#include "HiZOcclusion.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "Shader.h"
+#include "Tracer.h"
+
+namespace {
+
+// O nível lido pela CPU é o primeiro com no máximo esta largura (160x90 numa tela 1280x720)
+const int kReadbackWidth = 160;
+
+} // namespace
+
+void HiZOcclusion::Initialize(int width, int height) {
+    this->width = width;
+    this->height = height;
+    program = CreateProgram(loadShaderFromFile("fullscreen_vs.glsl"), loadShaderFromFile("hiz_fs.glsl"));
+    glGenVertexArrays(1, &emptyVao);
+
+    glGenTextures(1, &depthTexture);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glGenFramebuffers(1, &depthFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, depthFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+    // metade da tela por nível até a largura de leitura
+    glm::ivec2 size(width, height);
+    do {
+        size = glm::ivec2(std::max((size.x + 1) / 2, 1), std::max((size.y + 1) / 2, 1));
+        levelSizes.push_back(size);
+    } while (size.x > kReadbackWidth);
+
+    glGenTextures(1, &pyramid);
+    glBindTexture(GL_TEXTURE_2D, pyramid);
+    for (size_t level = 0; level < levelSizes.size(); level++) {
+        glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_R32F, levelSizes[level].x, levelSizes[level].y, 0,
+                GL_RED, GL_FLOAT, NULL);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levelSizes.size() - 1));
+    glGenFramebuffers(1, &reduceFbo);
+
+    glm::ivec2 last = levelSizes.back();
+    glGenBuffers(1, &pbo);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, last.x * last.y * sizeof(float), NULL, GL_STREAM_READ);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        throw std::runtime_error("Hi-Z framebuffer incomplete: " + std::to_string(status));
+    }
+}
+
+void HiZOcclusion::ReloadProgram() {
+    GLuint reloaded = CreateProgram(loadShaderFromFile("fullscreen_vs.glsl"), loadShaderFromFile("hiz_fs.glsl"));
+    glDeleteProgram(program);
+    program = reloaded;
+}
+
+void HiZOcclusion::Build(const glm::mat4& viewProjection) {
+    // a leitura anterior ainda não voltou: não sobrescreve o PBO em uso
+    if (fence)
+        return;
+
+    TRACE_SCOPE("HiZBuild");
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, depthFbo);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "source"), 0);
+    glBindVertexArray(emptyVao);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    glActiveTexture(GL_TEXTURE0);
+    glBindFramebuffer(GL_FRAMEBUFFER, reduceFbo);
+
+    glm::ivec2 sourceSize(width, height);
+    for (size_t level = 0; level < levelSizes.size(); level++) {
+        // lê só o nível anterior enquanto escreve este (sem laço de realimentação)
+        if (level == 0) {
+            glBindTexture(GL_TEXTURE_2D, depthTexture);
+        } else {
+            glBindTexture(GL_TEXTURE_2D, pyramid);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>(level - 1));
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(level - 1));
+        }
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pyramid, static_cast<GLint>(level));
+        glUniform2i(glGetUniformLocation(program, "sourceSize"), sourceSize.x, sourceSize.y);
+        glViewport(0, 0, levelSizes[level].x, levelSizes[level].y);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        sourceSize = levelSizes[level];
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glReadPixels(0, 0, sourceSize.x, sourceSize.y, GL_RED, GL_FLOAT, (void*)0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    pendingViewProjection = viewProjection;
+
+    glBindTexture(GL_TEXTURE_2D, pyramid);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levelSizes.size() - 1));
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void HiZOcclusion::Fetch() {
+    if (!fence)
+        return;
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+        return;  // a GPU ainda não chegou lá; usa a leitura anterior mais um frame
+    glDeleteSync(fence);
+    fence = 0;
+
+    const glm::ivec2& size = levelSizes.back();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    const void* data = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (data) {
+        cpuDepth.resize(size.x * size.y);
+        memcpy(cpuDepth.data(), data, cpuDepth.size() * sizeof(float));
+        cpuViewProjection = pendingViewProjection;
+    }
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+bool HiZOcclusion::IsOccluded(const glm::vec3& lo, const glm::vec3& hi) const {
+    if (cpuDepth.empty())
+        return false;
+
+    float minX = 1.0f, minY = 1.0f, maxX = -1.0f, maxY = -1.0f;
+    float nearest = 1.0f;
+    for (int i = 0; i < 8; i++) {
+        glm::vec4 p = cpuViewProjection * glm::vec4((i & 1) ? hi.x : lo.x, (i & 2) ? hi.y : lo.y, (i & 4) ? hi.z : lo.z, 1.0f);
+        // atravessa o plano da câmera: não dá para saber o retângulo, fica visível
+        if (p.w <= 1e-4f)
+            return false;
+        float x = p.x / p.w, y = p.y / p.w;
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+        nearest = std::min(nearest, p.z / p.w * 0.5f + 0.5f);
+    }
+    // fora da tela daquele frame: a pirâmide não sabe nada dali
+    if (maxX < -1.0f || maxY < -1.0f || minX > 1.0f || minY > 1.0f)
+        return false;
+
+    // NDC -> texel do último nível, preso às bordas
+    const glm::ivec2& size = levelSizes.back();
+    auto texel = [](float ndc, int extent) {
+        return std::min(std::max(static_cast<int>(std::floor((ndc * 0.5f + 0.5f) * extent)), 0), extent - 1);
+    };
+    int firstX = texel(minX, size.x), lastX = texel(maxX, size.x);
+    int firstY = texel(minY, size.y), lastY = texel(maxY, size.y);
+    for (int y = firstY; y <= lastY; y++) {
+        for (int x = firstX; x <= lastX; x++) {
+            if (cpuDepth[y * size.x + x] >= nearest)
+                return false;
+        }
+    }
+    return true;
+}
+
+HiZOcclusion::~HiZOcclusion() {
+    Destroy();
+}
+
+void HiZOcclusion::Destroy() {
+    if (fence) glDeleteSync(fence);
+    if (pbo) glDeleteBuffers(1, &pbo);
+    if (reduceFbo) glDeleteFramebuffers(1, &reduceFbo);
+    if (pyramid) glDeleteTextures(1, &pyramid);
+    if (depthFbo) glDeleteFramebuffers(1, &depthFbo);
+    if (depthTexture) glDeleteTextures(1, &depthTexture);
+    if (emptyVao) glDeleteVertexArrays(1, &emptyVao);
+    if (program) glDeleteProgram(program);
+    fence = 0;
+    pbo = reduceFbo = pyramid = depthFbo = depthTexture = emptyVao = program = 0;
+    levelSizes.clear();
+    cpuDepth.clear();
+}
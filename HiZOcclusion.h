@@ -0,0 +1,51 @@
+// HiZOcclusion.h
+#ifndef HIZ_OCCLUSION_H
+#define HIZ_OCCLUSION_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Oclusão pela profundidade do frame anterior: depois da geometria opaca, a profundidade do
+// framebuffer padrão é reduzida (máximo de cada bloco) até um nível pequeno, que volta para a
+// CPU por um PBO sem travar a GPU. No frame seguinte, antes de enviar os draws, a AABB de cada
+// objeto é projetada com a câmera daquele frame: se o ponto mais próximo dela ainda está atrás
+// de tudo o que foi desenhado no retângulo que ela cobre, o objeto fica de fora.
+//   occlusion.Fetch();                     início do frame: pega a leitura pronta, se houver
+//   occlusion.IsOccluded(min, max);        por objeto
+//   occlusion.Build(viewProjection);       depois da geometria opaca
+class HiZOcclusion {
+public:
+    HiZOcclusion() = default;
+    ~HiZOcclusion();
+    HiZOcclusion(const HiZOcclusion&) = delete;
+    HiZOcclusion& operator=(const HiZOcclusion&) = delete;
+
+    // Tamanho do framebuffer da janela
+    void Initialize(int width, int height);
+    void Destroy();
+    void ReloadProgram();  // hot reload de hiz_fs.glsl; lança e mantém o atual se falhar
+
+    void Build(const glm::mat4& viewProjection);
+    void Fetch();
+    // Sem leitura ainda (primeiros frames) nada é ocluído
+    bool IsOccluded(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+    void Invalidate() { cpuDepth.clear(); }
+
+private:
+    int width{0}, height{0};
+    GLuint program{0};
+    GLuint emptyVao{0};
+    GLuint depthFbo{0}, depthTexture{0};  // cópia da profundidade da tela (D24S8, como o framebuffer padrão)
+    GLuint reduceFbo{0}, pyramid{0};      // R32F com mipmaps; o nível 0 tem metade da tela
+    std::vector<glm::ivec2> levelSizes;   // o último é o lido pela CPU
+
+    GLuint pbo{0};
+    GLsync fence{0};
+    glm::mat4 pendingViewProjection{1.0f};
+
+    std::vector<float> cpuDepth;  // último nível lido, linha 0 embaixo
+    glm::mat4 cpuViewProjection{1.0f};
+};
+
+#endif
@@ -0,0 +1,87 @@
+// HotReload.cpp
+#include "HotReload.h"
+#include <iostream>
+#include <dirent.h>
+#include "Shader.h"
+
+namespace {
+
+bool EndsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+HotReload::~HotReload() {
+    Stop();
+}
+
+void HotReload::Start(const std::vector<std::string>& texturePaths) {
+    // conteúdo atual dos shaders, para ignorar gravações que não mudam nada
+    if (DIR* dir = opendir(".")) {
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (EndsWith(name, ".glsl"))
+                shaderHashes[name] = HashText(loadShaderFromFile(name.c_str()));
+        }
+        closedir(dir);
+    }
+
+    std::set<std::string> directories = {"."};
+    for (const auto& path : texturePaths) {
+        textures.insert(path);
+        size_t slash = path.rfind('/');
+        directories.insert(slash == std::string::npos ? "." : path.substr(0, slash));
+    }
+    watcher.Start(std::vector<std::string>(directories.begin(), directories.end()),
+            [this](const std::string& path) { OnChange(path); });
+}
+
+void HotReload::Stop() {
+    watcher.Stop();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& entry : decoded) {
+        TextureCache::Free(entry.second);
+    }
+    decoded.clear();
+}
+
+void HotReload::OnChange(const std::string& path) {
+    if (EndsWith(path, ".glsl")) {
+        // salvar sem mudar nada (ou um arquivo vazio no meio da gravação) não recompila
+        std::string source = loadShaderFromFile(path.c_str());
+        uint64_t hash = HashText(source);
+        if (source.empty() || shaderHashes[path] == hash)
+            return;
+        shaderHashes[path] = hash;
+
+        std::cout << "Shader changed: " << path << std::endl;
+        std::lock_guard<std::mutex> lock(mutex);
+        shadersChanged = true;
+        return;
+    }
+
+    if (textures.count(path)) {
+        DecodedImage image = TextureCache::Decode(path);
+        if (!image.pixels) {
+            std::cerr << "Cannot reload texture " << path << std::endl;
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        decoded.push_back(std::make_pair(path, image));
+    }
+}
+
+bool HotReload::TakeShaderChange() {
+    std::lock_guard<std::mutex> lock(mutex);
+    bool changed = shadersChanged;
+    shadersChanged = false;
+    return changed;
+}
+
+std::vector<std::pair<std::string, DecodedImage>> HotReload::TakeTextures() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::pair<std::string, DecodedImage>> taken;
+    taken.swap(decoded);
+    return taken;
+}
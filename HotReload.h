@@ -0,0 +1,42 @@
+// HotReload.h
+#ifndef HOT_RELOAD_H
+#define HOT_RELOAD_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "FileWatcher.h"
+#include "TextureCache.h"
+
+// Recarga de shaders e texturas sem reiniciar. A thread do watcher faz a parte cara:
+// confere se o conteúdo mudou de fato e já decodifica as imagens. A thread de render só
+// recolhe o resultado entre frames (recompila os programas e reenvia as texturas no lugar).
+class HotReload {
+public:
+    HotReload() = default;
+    ~HotReload();
+
+    // Shaders (*.glsl) no diretório atual e as texturas da cena nos seus diretórios
+    void Start(const std::vector<std::string>& texturePaths);
+    void Stop();
+
+    bool TakeShaderChange();
+    std::vector<std::pair<std::string, DecodedImage>> TakeTextures();  // pixels ficam com quem recebe
+
+private:
+    FileWatcher watcher;
+    std::set<std::string> textures;
+    std::map<std::string, uint64_t> shaderHashes;  // só na thread do watcher
+
+    std::mutex mutex;
+    bool shadersChanged{false};
+    std::vector<std::pair<std::string, DecodedImage>> decoded;
+
+    void OnChange(const std::string& path);
+};
+
+#endif
@@ -0,0 +1,271 @@
+// Impostors.cpp
+#include "Impostors.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include "Shader.h"
+#include "Tracer.h"
+
+namespace {
+
+const int kRows = Impostors::kViews / Impostors::kColumns;
+const int kLayers = 3;  // saídas de impostor_bake_fs.glsl
+
+// O que impostor_bake_fs.glsl lê de cada grupo, com a emissão de fonte apagada como ApplyMaterial
+bool SameBake(const std::vector<MaterialProperties>& a, const std::vector<MaterialProperties>& b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].isLightSource != b[i].isLightSource)
+            return false;
+        if (a[i].isLightSource) {
+            glm::vec3 emissionA = a[i].isActive ? a[i].emission : glm::vec3(0.1f);
+            glm::vec3 emissionB = b[i].isActive ? b[i].emission : glm::vec3(0.1f);
+            if (emissionA != emissionB)
+                return false;
+        } else if (a[i].diffuseReflection != b[i].diffuseReflection) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+void Impostors::Initialize() {
+    bakeProgram = CreateProgram(loadShaderFromFile("vs.glsl"), loadShaderFromFile("impostor_bake_fs.glsl"));
+    program = CreateProgram(loadShaderFromFile("impostor_vs.glsl"), loadShaderFromFile("impostor_fs.glsl"));
+
+    const float corners[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    glGenBuffers(1, &quadVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+
+    // atributos por instância; o ponteiro muda por atlas em Draw
+    glGenBuffers(1, &instanceVbo);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    glBindVertexArray(0);
+}
+
+void Impostors::ReloadProgram() {
+    GLuint reloaded = CreateProgram(loadShaderFromFile("impostor_vs.glsl"), loadShaderFromFile("impostor_fs.glsl"));
+    glDeleteProgram(program);
+    program = reloaded;
+}
+
+int Impostors::Bake(const std::vector<Object*>& objects) {
+    TRACE_SCOPE("Impostors::Bake");
+    int baked = 0;
+    for (Object* object : objects) {
+        if (object->impostorDistance > 0.0f)
+            atlasOf[object] = AtlasFor(*object, object->materials, baked);
+    }
+    batches.resize(atlases.size());
+    return baked;
+}
+
+int Impostors::Update(const FrameSnapshot& snapshot) {
+    int baked = 0;
+    for (const auto& state : snapshot.objects) {
+        if (!state.impostor)
+            continue;
+        size_t& index = atlasOf.at(state.object);
+        if (SameBake(atlases[index].materials, state.materials))
+            continue;
+        TRACE_SCOPE_DETAIL("RebakeImpostor", state.object->name.c_str());
+        size_t previous = index;
+        index = AtlasFor(*state.object, state.materials, baked);
+        ReleaseUnused(previous);
+    }
+    batches.resize(atlases.size());
+    return baked;
+}
+
+size_t Impostors::AtlasFor(Object& object, const std::vector<MaterialProperties>& materials, int& baked) {
+    size_t free = atlases.size();
+    for (size_t i = 0; i < atlases.size(); i++) {
+        const Atlas& atlas = atlases[i];
+        if (!atlas.texture) {
+            free = std::min(free, i);
+            continue;
+        }
+        if (atlas.mesh == &object.GetMesh() && atlas.textures == object.GetTextures() &&
+                SameBake(atlas.materials, materials))
+            return i;
+    }
+    if (free == atlases.size())
+        atlases.emplace_back();
+    BakeAtlas(atlases[free], object, materials);
+    baked++;
+    return free;
+}
+
+// Atlas que nenhum objeto usa mais (materiais mudaram): a posição fica livre para o próximo
+void Impostors::ReleaseUnused(size_t index) {
+    for (const auto& entry : atlasOf) {
+        if (entry.second == index)
+            return;
+    }
+    Atlas& atlas = atlases[index];
+    glDeleteTextures(1, &atlas.texture);
+    atlas = Atlas();
+}
+
+void Impostors::BakeAtlas(Atlas& atlas, Object& object, const std::vector<MaterialProperties>& materials) {
+    TRACE_SCOPE_DETAIL("BakeImpostor", object.name.c_str());
+    const Mesh& mesh = object.GetMesh();
+    atlas.mesh = &mesh;
+    atlas.textures = object.GetTextures();
+    atlas.materials = materials;
+    atlas.center = (mesh.boundsMin + mesh.boundsMax) * 0.5f;
+    atlas.radius = std::max(glm::length(mesh.boundsMax - mesh.boundsMin) * 0.5f, 1e-3f);
+
+    int width = kColumns * kTileSize, height = kRows * kTileSize;
+    glGenTextures(1, &atlas.texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, atlas.texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, kLayers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    GLuint fbo, depth;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    for (int layer = 0; layer < kLayers; layer++) {
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + layer, atlas.texture, 0, layer);
+    }
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    const GLenum buffers[kLayers] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2};
+    glDrawBuffers(kLayers, buffers);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+    if (status == GL_FRAMEBUFFER_COMPLETE) {
+        glDisable(GL_BLEND);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glUseProgram(bakeProgram);
+        float r = atlas.radius;
+        glm::mat4 projection = glm::ortho(-r, r, -r, r, 0.0f, 4.0f * r);
+        glUniformMatrix4fv(glGetUniformLocation(bakeProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+        for (int view = 0; view < kViews; view++) {
+            // vista de fora para dentro na direção (sin a, 0, cos a), como impostor_vs.glsl espera
+            float angle = view * 2.0f * 3.14159265f / kViews;
+            glm::vec3 direction(std::sin(angle), 0.0f, std::cos(angle));
+            glm::mat4 lookAt = glm::lookAt(atlas.center + direction * 2.0f * r, atlas.center, glm::vec3(0.0f, 1.0f, 0.0f));
+            glUniformMatrix4fv(glGetUniformLocation(bakeProgram, "view"), 1, GL_FALSE, glm::value_ptr(lookAt));
+
+            glViewport((view % kColumns) * kTileSize, (view / kColumns) * kTileSize, kTileSize, kTileSize);
+            object.Draw(bakeProgram, glm::mat4(1.0f), materials);
+        }
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, atlas.texture);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        glEnable(GL_BLEND);
+    }
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteRenderbuffers(1, &depth);
+    glDeleteFramebuffers(1, &fbo);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        throw std::runtime_error("Impostor framebuffer incomplete: " + std::to_string(status));
+    }
+}
+
+int Impostors::Draw(const FrameSnapshot& snapshot) {
+    for (auto& batch : batches) {
+        batch.clear();
+    }
+
+    int count = 0;
+    for (const auto& state : snapshot.objects) {
+        if (!state.impostor)
+            continue;
+        size_t index = atlasOf.at(state.object);
+        const Atlas& atlas = atlases[index];
+        // centro, escala e giro em Y saem da matriz congelada do frame
+        glm::vec3 center = glm::vec3(state.model * glm::vec4(atlas.center, 1.0f));
+        float scale = glm::length(glm::vec3(state.model[0]));
+        float yaw = std::atan2(-state.model[0][2], state.model[0][0]);
+        batches[index].push_back({glm::vec4(center, atlas.radius * scale), yaw});
+        count++;
+    }
+    if (count == 0)
+        return 0;
+
+    TRACE_SCOPE("Impostors");
+    glUseProgram(program);
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(snapshot.view));
+    glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, glm::value_ptr(snapshot.projection));
+    glUniform3fv(glGetUniformLocation(program, "viewPos"), 1, glm::value_ptr(snapshot.viewPos));
+    glUniform3fv(glGetUniformLocation(program, "dirLight.direction"), 1, glm::value_ptr(snapshot.dirLight.direction));
+    glUniform3fv(glGetUniformLocation(program, "dirLight.ambient"), 1, glm::value_ptr(snapshot.dirLight.ambient));
+    glUniform3fv(glGetUniformLocation(program, "dirLight.diffuse"), 1, glm::value_ptr(snapshot.dirLight.diffuse));
+    glUniform1i(glGetUniformLocation(program, "atlas"), 0);
+
+    // um buffer com todos os lotes; cada draw aponta os atributos para o seu trecho
+    std::vector<Instance> instances;
+    instances.reserve(count);
+    for (const auto& batch : batches) {
+        instances.insert(instances.end(), batch.begin(), batch.end());
+    }
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(Instance), instances.data(), GL_STREAM_DRAW);
+
+    glActiveTexture(GL_TEXTURE0);
+    size_t first = 0;
+    for (size_t i = 0; i < batches.size(); i++) {
+        if (batches[i].empty())
+            continue;
+        size_t offset = first * sizeof(Instance);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(offset + offsetof(Instance, centerRadius)));
+        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(offset + offsetof(Instance, yaw)));
+        glBindTexture(GL_TEXTURE_2D_ARRAY, atlases[i].texture);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(batches[i].size()));
+        first += batches[i].size();
+    }
+    glBindVertexArray(0);
+    return count;
+}
+
+Impostors::~Impostors() {
+    Destroy();
+}
+
+void Impostors::Destroy() {
+    for (auto& atlas : atlases) {
+        if (atlas.texture) glDeleteTextures(1, &atlas.texture);
+    }
+    atlases.clear();
+    atlasOf.clear();
+    batches.clear();
+    if (vao) glDeleteVertexArrays(1, &vao);
+    if (quadVbo) glDeleteBuffers(1, &quadVbo);
+    if (instanceVbo) glDeleteBuffers(1, &instanceVbo);
+    if (bakeProgram) glDeleteProgram(bakeProgram);
+    if (program) glDeleteProgram(program);
+    vao = quadVbo = instanceVbo = bakeProgram = program = 0;
+}
@@ -0,0 +1,72 @@
+// Impostors.h
+#ifndef IMPOSTORS_H
+#define IMPOSTORS_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <map>
+#include <utility>
+#include <vector>
+#include "FrameSnapshot.h"
+
+// Impostores: na carga, cada objeto com "impostor" na cena é desenhado de kViews direções em
+// volta de Y num atlas (albedo, normal, reflexão difusa). Longe da câmera, o objeto vira um quad
+// que mistura as duas vistas mais próximas; todos os quads de um atlas saem num draw instanciado,
+// então uma floresta da mesma árvore custa quase o mesmo que uma árvore. O atlas guarda a emissão e a
+// reflexão difusa dos materiais: quando elas mudam (F, E/R) o objeto ganha outro atlas no próximo frame.
+//   impostors.Bake(objects);     uma vez, depois do Upload dos meshes
+//   impostors.Update(snapshot);  a cada frame, antes dos passes (refaz atlas de materiais alterados)
+//   impostors.Draw(snapshot);    depois da geometria opaca (forward ou deferred), antes do céu
+class Impostors {
+public:
+    static const int kViews = 16;   // VIEWS em impostor_vs.glsl
+    static const int kColumns = 4;  // COLUMNS em impostor_vs.glsl
+    static const int kTileSize = 256;
+
+    Impostors() = default;
+    ~Impostors();
+    Impostors(const Impostors&) = delete;
+    Impostors& operator=(const Impostors&) = delete;
+
+    void Initialize();
+    void Destroy();
+    void ReloadProgram();  // hot reload de impostor_vs/impostor_fs; lança e mantém o atual se falhar
+
+    // Objetos com o mesmo mesh e as mesmas texturas dividem um atlas; retorna quantos foram feitos
+    int Bake(const std::vector<Object*>& objects);
+    // Objetos desenhados como impostor cujos materiais no snapshot não são os do seu atlas passam para
+    // um atlas com esses materiais (assado se não existe); retorna quantos foram assados
+    int Update(const FrameSnapshot& snapshot);
+
+    // Desenha os objetos marcados com impostor no snapshot; retorna quantos
+    int Draw(const FrameSnapshot& snapshot);
+
+private:
+    struct Atlas {
+        GLuint texture{0};       // GL_TEXTURE_2D_ARRAY: albedo, normal, diffuse; 0 = posição livre
+        glm::vec3 center{0.0f};  // esfera envolvente em coordenadas do modelo
+        float radius{1.0f};
+        // o que foi assado: objetos com o mesmo mesh, texturas e materiais dividem o atlas
+        const Mesh* mesh{nullptr};
+        std::vector<GLuint> textures;
+        std::vector<MaterialProperties> materials;
+    };
+    struct Instance {
+        glm::vec4 centerRadius;
+        float yaw;
+    };
+
+    GLuint bakeProgram{0};
+    GLuint program{0};
+    GLuint vao{0}, quadVbo{0}, instanceVbo{0};
+
+    std::vector<Atlas> atlases;
+    std::map<const Object*, size_t> atlasOf;
+    std::vector<std::vector<Instance>> batches;  // por atlas, reaproveitado entre frames
+
+    size_t AtlasFor(Object& object, const std::vector<MaterialProperties>& materials, int& baked);
+    void BakeAtlas(Atlas& atlas, Object& object, const std::vector<MaterialProperties>& materials);
+    void ReleaseUnused(size_t index);
+};
+
+#endif
@@ -0,0 +1,38 @@
+// LoadArena.cpp
+#include "LoadArena.h"
+#include <sys/mman.h>
+#include <cstdlib>
+#include <new>
+
+LoadArena::LoadArena(size_t capacity) : capacity(capacity) {
+    if (capacity == 0)
+        return;
+    // MAP_NORESERVE: só reserva endereços; o que não for tocado não conta no RSS
+    void* memory = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (memory == MAP_FAILED) {
+        this->capacity = 0;  // tudo pelo heap
+        return;
+    }
+    base = static_cast<char*>(memory);
+}
+
+LoadArena::~LoadArena() {
+    if (base)
+        munmap(base, capacity);
+    for (void* block : overflow)
+        free(block);
+}
+
+void* LoadArena::Allocate(size_t bytes, size_t alignment) {
+    size_t start = (used + alignment - 1) & ~(alignment - 1);
+    if (base && start + bytes <= capacity) {
+        used = start + bytes;
+        return base + start;
+    }
+
+    void* block = nullptr;
+    if (posix_memalign(&block, alignment < sizeof(void*) ? sizeof(void*) : alignment, bytes ? bytes : 1) != 0)
+        throw std::bad_alloc();
+    overflow.push_back(block);
+    return block;
+}
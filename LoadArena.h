@@ -0,0 +1,57 @@
+// LoadArena.h
+#ifndef LOAD_ARENA_H
+#define LOAD_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+// Arena linear para os dados temporários da carga de um arquivo (texto do .obj, tabelas v/vt/vn).
+// Reserva espaço de endereço com mmap (as páginas só ocupam RAM quando tocadas) e entrega blocos
+// em sequência, sem free individual; tudo volta ao sistema de uma vez no destrutor.
+// Se a estimativa estourar, os blocos seguintes vêm do heap (mais lento, mas correto).
+//   LoadArena arena(estimativa);
+//   char* text = arena.AllocateArray<char>(size);
+//   ArenaVector<glm::vec3> positions{ArenaAllocator<glm::vec3>(arena)};
+class LoadArena {
+public:
+    explicit LoadArena(size_t capacity);
+    ~LoadArena();
+    LoadArena(const LoadArena&) = delete;
+    LoadArena& operator=(const LoadArena&) = delete;
+
+    void* Allocate(size_t bytes, size_t alignment);
+    template <typename T>
+    T* AllocateArray(size_t count) { return static_cast<T*>(Allocate(count * sizeof(T), alignof(T))); }
+    size_t Used() const { return used; }
+
+private:
+    char* base{nullptr};
+    size_t capacity{0};
+    size_t used{0};
+    std::vector<void*> overflow;
+};
+
+// Para std::vector dentro da arena: deallocate não faz nada, crescer deixa o bloco antigo para trás
+// (por isso vale reservar o tamanho contado antes)
+template <typename T>
+struct ArenaAllocator {
+    typedef T value_type;
+    LoadArena* arena;
+
+    explicit ArenaAllocator(LoadArena& arena) : arena(&arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t count) { return arena->AllocateArray<T>(count); }
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif
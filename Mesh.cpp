@@ -0,0 +1,1120 @@
+// Mesh.cpp
+#include "Mesh.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <sys/stat.h>
+#include "FloatParser.h"
+#include "LoadArena.h"
+#include "MeshSimplifier.h"
+#include "Tracer.h"
+
+namespace {
+// Nenhum nível para meshes pequenos; a partir daí, erro máximo de cada nível em fração da diagonal da AABB
+const size_t kMinLodTriangles = 2000;
+const float kLodTolerance[Mesh::kMaxLods] = {0.0f, 0.004f, 0.01f, 0.025f};
+// Proxy de oclusão: alvo de triângulos e erro máximo (fração da diagonal). Só vértices originais,
+// então o proxy não sai da AABB; bordas abertas (portas, janelas) ficam presas e não fecham
+const size_t kOccluderTriangles = 256;
+const float kOccluderTolerance = 0.01f;
+// .obj menores que isso por thread não compensam o custo de dividir
+const size_t kMinChunkBytes = 1 << 20;
+// Streaming: de quantos em quantos vértices resolvidos o parser publica o prefixo pronto
+const size_t kProgressVertices = 3 * 4096;
+// Normais geradas para faces sem vn: faces vizinhas mais inclinadas que isso ficam com aresta viva
+const float kCreaseAngle = 60.0f;  // graus
+// Em cornerPositions: o canto não tinha vn
+const uint32_t kMissingNormal = 0x80000000u;
+// Menos triângulos que isso por thread não compensam o custo de dividir
+const size_t kMinRangeTriangles = 1 << 16;
+
+// Cache de LoadOBJ (Mesh::EnableCache); vazio: desligado. O número do magic muda junto com o formato
+// ou com o que LoadOBJ produz (kCreaseAngle, por exemplo)
+std::string meshCacheDirectory;
+const char kMeshCacheMagic[4] = {'M', 'S', 'H', '1'};
+const uint32_t kMaxCacheString = 1 << 16;
+
+// Tamanho e mtime (ns) de um arquivo; ausente é size = UINT64_MAX
+struct FileStamp {
+    uint64_t size{UINT64_MAX};
+    int64_t mtime{0};
+    bool operator==(const FileStamp& other) const { return size == other.size && mtime == other.mtime; }
+};
+
+FileStamp Stamp(const std::string& path) {
+    FileStamp stamp;
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0) {
+        stamp.size = static_cast<uint64_t>(info.st_size);
+        stamp.mtime = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+    }
+    return stamp;
+}
+
+std::string MeshCachePath(const std::string& path) {
+    uint64_t hash = 1469598103934665603ull;  // FNV-1a
+    for (unsigned char c : path)
+        hash = (hash ^ c) * 1099511628211ull;
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.mesh", static_cast<unsigned long long>(hash));
+    return meshCacheDirectory + "/" + name;
+}
+
+template <typename T>
+void WriteValue(std::ostream& file, const T& value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool ReadValue(std::istream& file, T& value) {
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+void WriteString(std::ostream& file, const std::string& text) {
+    WriteValue(file, static_cast<uint32_t>(text.size()));
+    file.write(text.data(), text.size());
+}
+
+bool ReadString(std::istream& file, std::string& text) {
+    uint32_t length = 0;
+    if (!ReadValue(file, length) || length > kMaxCacheString)
+        return false;
+    text.assign(length, '\0');
+    return length == 0 || static_cast<bool>(file.read(&text[0], length));
+}
+
+// float -> half (IEEE 754 binary16), arredondando para o mais próximo
+uint16_t FloatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    int exponent = static_cast<int>((bits >> 23) & 0xffu) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffffu;
+    if (exponent >= 31)
+        return static_cast<uint16_t>(sign | 0x7c00u);  // grande demais: infinito
+    if (exponent <= 0) {
+        // subnormal do half (ou zero)
+        if (exponent < -10)
+            return static_cast<uint16_t>(sign);
+        mantissa |= 0x800000u;
+        int shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1u)
+            half++;
+        return static_cast<uint16_t>(sign | half);
+    }
+    uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000u)
+        half++;  // o vai-um pode subir o expoente, que é o certo
+    return static_cast<uint16_t>(half);
+}
+
+// Leitura do .obj em memória (texto terminado em '\0')
+bool IsSpace(char c) {
+    return c == ' ' || c == '\t';
+}
+
+const char* SkipSpaces(const char* p) {
+    while (IsSpace(*p))
+        p++;
+    return p;
+}
+
+// Só '\n' quebra a linha: um '\0' no meio do arquivo é um caractere qualquer até end
+const char* NextLine(const char* p, const char* end) {
+    while (p < end && *p != '\n')
+        p++;
+    return p < end ? p + 1 : end;
+}
+
+float ReadFloat(const char*& p) {
+    float value;
+    p = ParseFloat(SkipSpaces(p), value);
+    return value;
+}
+
+// Fim da linha (ou do arquivo), para os comandos que leem até o fim dela
+bool IsLineEnd(char c) {
+    return c == '\n' || c == '\r' || c == '\0';
+}
+
+// Palavra até o próximo espaço ou fim de linha
+std::string ReadWord(const char*& p) {
+    p = SkipSpaces(p);
+    const char* begin = p;
+    while (!IsSpace(*p) && !IsLineEnd(*p))
+        p++;
+    return std::string(begin, p);
+}
+
+// Inteiro com sinal opcional; sem dígitos fica 0 (ausente)
+const char* ParseIndex(const char* p, int& index) {
+    bool negative = *p == '-';
+    if (negative)
+        p++;
+    int value = 0;
+    while (*p >= '0' && *p <= '9')
+        value = value * 10 + (*p++ - '0');
+    index = negative ? -value : value;
+    return p;
+}
+
+// "v", "v/t", "v//n" ou "v/t/n"; índice ausente fica 0, negativo conta a partir do último definido
+const char* ParseCorner(const char* p, int index[3]) {
+    index[0] = index[1] = index[2] = 0;
+    for (int k = 0; k < 3; k++) {
+        if (k > 0) {
+            if (*p != '/')
+                break;
+            p++;
+        }
+        p = ParseIndex(p, index[k]);
+    }
+    return p;
+}
+
+// Cantos de uma linha "f" (p logo depois do 'f'), até o fim da linha ou um comentário
+size_t CountCorners(const char* p) {
+    size_t corners = 0;
+    while (true) {
+        p = SkipSpaces(p);
+        if (IsLineEnd(*p) || *p == '#')
+            return corners;
+        corners++;
+        while (!IsSpace(*p) && !IsLineEnd(*p))
+            p++;
+    }
+}
+
+// Triângulos do leque de uma face de n cantos (menos de 3: nenhum, a face é inválida)
+size_t FanCorners(size_t corners) {
+    return corners >= 3 ? (corners - 2) * 3 : 0;
+}
+
+// Índice do .obj -> posição na tabela de count elementos já definidos (1 = primeiro, -1 = último).
+// 0 (ausente) vira -1; fora da tabela vira -2
+long ResolveIndex(int index, size_t count) {
+    long resolved = index < 0 ? static_cast<long>(count) + index : static_cast<long>(index) - 1;
+    if (index == 0)
+        return -1;
+    return resolved < 0 || resolved >= static_cast<long>(count) ? -2 : resolved;
+}
+
+// Pedaço do .obj que começa e termina em fim de linha; os *First são os índices globais das
+// primeiras linhas v/vt/vn/f do pedaço (soma de prefixos das contagens dos pedaços anteriores)
+struct ObjChunk {
+    const char* begin;
+    const char* end;
+    size_t positions{0}, texcoords{0}, normals{0}, corners{0};
+    size_t positionFirst{0}, texcoordFirst{0}, normalFirst{0}, cornerFirst{0};
+    std::vector<std::pair<std::string, size_t>> materials;  // usemtl: nome e primeiro vértice do pedaço
+    std::vector<std::string> libraries;                      // mtllib
+    size_t missingNormals{0};                                // cantos escritos sem vn
+    bool valid{true};
+
+    ObjChunk(const char* begin, const char* end) : begin(begin), end(end) {}
+};
+
+// Contagem, usemtl (com o vértice inicial relativo ao pedaço) e mtllib: depois dela os grupos
+// e o tamanho de vertices já são conhecidos, antes de qualquer face ser resolvida
+void CountChunk(ObjChunk& chunk) {
+    for (const char* p = SkipSpaces(chunk.begin); p < chunk.end; p = SkipSpaces(NextLine(p, chunk.end))) {
+        if (p[0] == 'v' && IsSpace(p[1])) chunk.positions++;
+        else if (p[0] == 'v' && p[1] == 't' && IsSpace(p[2])) chunk.texcoords++;
+        else if (p[0] == 'v' && p[1] == 'n' && IsSpace(p[2])) chunk.normals++;
+        else if (p[0] == 'f' && IsSpace(p[1])) chunk.corners += FanCorners(CountCorners(p + 1));
+        else if (strncmp(p, "usemtl", 6) == 0 && IsSpace(p[6])) {
+            const char* name = SkipSpaces(p + 6);
+            const char* nameEnd = name;
+            while (*nameEnd && !IsSpace(*nameEnd) && *nameEnd != '\r' && *nameEnd != '\n')
+                nameEnd++;
+            chunk.materials.push_back({std::string(name, nameEnd), chunk.corners});
+        }
+        else if (strncmp(p, "mtllib", 6) == 0 && IsSpace(p[6])) {
+            const char* cursor = p + 6;
+            for (std::string name = ReadWord(cursor); !name.empty(); name = ReadWord(cursor))
+                chunk.libraries.push_back(name);
+        }
+    }
+}
+
+// 1ª passada: v/vt/vn direto na posição global de cada tabela
+void ParseAttributes(const ObjChunk& chunk, glm::vec3* positions, glm::vec2* texcoords, glm::vec3* normals) {
+    positions += chunk.positionFirst;
+    texcoords += chunk.texcoordFirst;
+    normals += chunk.normalFirst;
+    for (const char* p = SkipSpaces(chunk.begin); p < chunk.end; p = SkipSpaces(NextLine(p, chunk.end))) {
+        if (p[0] == 'v' && IsSpace(p[1])) {
+            const char* cursor = p + 1;
+            glm::vec3& vertex = *positions++;
+            vertex.x = ReadFloat(cursor);
+            vertex.y = ReadFloat(cursor);
+            vertex.z = ReadFloat(cursor);
+        }
+        else if (p[0] == 'v' && p[1] == 't' && IsSpace(p[2])) {
+            const char* cursor = p + 2;
+            glm::vec2& tex = *texcoords++;
+            tex.x = ReadFloat(cursor);
+            tex.y = ReadFloat(cursor);
+        }
+        else if (p[0] == 'v' && p[1] == 'n' && IsSpace(p[2])) {
+            const char* cursor = p + 2;
+            glm::vec3& normal = *normals++;
+            normal.x = ReadFloat(cursor);
+            normal.y = ReadFloat(cursor);
+            normal.z = ReadFloat(cursor);
+        }
+    }
+}
+
+// 2ª passada: faces resolvidas contra as tabelas já completas, escritas a partir de cornerFirst.
+// Os contadores de v/vt/vn seguem o arquivo para que só valham índices já definidos na linha da face.
+// cornerPositions recebe o v de cada canto (| kMissingNormal sem vn), para GenerateNormals.
+// Com progress, publica a cada kProgressVertices o índice global até onde out já está escrito,
+// até o primeiro canto sem vn (a normal dele só sai depois de todas as faces)
+void ParseFaces(ObjChunk& chunk, const glm::vec3* positions, const glm::vec2* texcoords, const glm::vec3* normals,
+                Vertex* out, uint32_t* cornerPositions, std::atomic<size_t>* progress) {
+    size_t positionCount = chunk.positionFirst, texcoordCount = chunk.texcoordFirst, normalCount = chunk.normalFirst;
+    size_t vertex_count = chunk.cornerFirst;
+    size_t published = vertex_count;
+    for (const char* p = SkipSpaces(chunk.begin); p < chunk.end; p = SkipSpaces(NextLine(p, chunk.end))) {
+        if (p[0] == 'v' && IsSpace(p[1])) positionCount++;
+        else if (p[0] == 'v' && p[1] == 't' && IsSpace(p[2])) texcoordCount++;
+        else if (p[0] == 'v' && p[1] == 'n' && IsSpace(p[2])) normalCount++;
+        else if (p[0] == 'f' && IsSpace(p[1])) {
+            // n-gon vira leque em volta do primeiro canto: (0, k-1, k) para k = 2..n-1.
+            // Lê exatamente os cantos contados em CountChunk, então escreve o que foi reservado
+            const char* cursor = p + 1;
+            size_t corners = CountCorners(cursor);
+            if (corners < 3) {
+                chunk.valid = false;
+                return;
+            }
+            Vertex first{}, previous{};
+            uint32_t firstPosition = 0, previousPosition = 0;
+            for (size_t corner = 0; corner < corners; corner++) {
+                int index[3];
+                cursor = ParseCorner(SkipSpaces(cursor), index);
+                long position = ResolveIndex(index[0], positionCount);
+                long texcoord = ResolveIndex(index[1], texcoordCount);
+                long normal = ResolveIndex(index[2], normalCount);
+                if ((!IsSpace(*cursor) && !IsLineEnd(*cursor) && *cursor != '#') ||
+                    position < 0 || texcoord < -1 || normal < -1) {
+                    chunk.valid = false;
+                    return;
+                }
+
+                Vertex vertex;
+                vertex.position = positions[position];
+                vertex.texture_coord = texcoord >= 0 ? texcoords[texcoord] : glm::vec2(0.0f);
+                vertex.normal = normal >= 0 ? normals[normal] : glm::vec3(0.0f, 1.0f, 0.0f);
+                uint32_t vertexPosition = static_cast<uint32_t>(position) | (normal >= 0 ? 0 : kMissingNormal);
+                if (corner == 0) {
+                    first = vertex;
+                    firstPosition = vertexPosition;
+                } else if (corner >= 2) {
+                    cornerPositions[vertex_count] = firstPosition;
+                    out[vertex_count++] = first;
+                    cornerPositions[vertex_count] = previousPosition;
+                    out[vertex_count++] = previous;
+                    cornerPositions[vertex_count] = vertexPosition;
+                    out[vertex_count++] = vertex;
+                    chunk.missingNormals += ((firstPosition & kMissingNormal) != 0) +
+                            ((previousPosition & kMissingNormal) != 0) + ((vertexPosition & kMissingNormal) != 0);
+                }
+                previous = vertex;
+                previousPosition = vertexPosition;
+            }
+            if (progress && chunk.missingNormals == 0 && vertex_count - published >= kProgressVertices) {
+                progress->store(vertex_count, std::memory_order_release);
+                published = vertex_count;
+            }
+        }
+    }
+}
+
+// .mtl -> materials (newmtl, Kd, Ks, Ke, Ns, map_Kd; o resto é ignorado). Arquivo ausente não é erro:
+// a cena normalmente define os materiais
+void LoadMaterialLibrary(const std::string& path, std::map<std::string, ObjMaterial>& materials) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return;
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    size_t size = content.size();
+    content.append(1 + kParsePadding, '\0');
+    const char* end = content.c_str() + size;
+    std::string directory = path.substr(0, path.find_last_of('/') + 1);
+
+    ObjMaterial* material = nullptr;
+    for (const char* p = SkipSpaces(content.c_str()); p < end; p = SkipSpaces(NextLine(p, end))) {
+        const char* cursor = p;
+        std::string key = ReadWord(cursor);
+        if (key == "newmtl") {
+            material = &materials[ReadWord(cursor)];
+            continue;
+        }
+        if (!material)
+            continue;
+        if (key == "Kd" || key == "Ks" || key == "Ke") {
+            glm::vec3 color;
+            color.x = ReadFloat(cursor);
+            color.y = ReadFloat(cursor);
+            color.z = ReadFloat(cursor);
+            (key == "Kd" ? material->diffuse : key == "Ks" ? material->specular : material->emission) = color;
+        }
+        else if (key == "Ns") {
+            material->shininess = ReadFloat(cursor);
+        }
+        else if (key == "map_Kd") {
+            // opções (-s, -o, ...) vêm antes; o arquivo é a última palavra
+            std::string texture;
+            for (std::string word = ReadWord(cursor); !word.empty(); word = ReadWord(cursor))
+                texture = word;
+            if (!texture.empty())
+                material->texture = texture[0] == '/' ? texture : directory + texture;
+        }
+    }
+}
+
+// Roda work em cada pedaço: o primeiro na thread atual, os outros com std::async.
+// done é chamado na thread atual para cada pedaço terminado, na ordem do arquivo
+template <typename Work, typename Done>
+void ForEachChunk(std::vector<ObjChunk>& chunks, Work work, Done done) {
+    std::vector<std::future<void>> pending;
+    for (size_t i = 1; i < chunks.size(); i++)
+        pending.push_back(std::async(std::launch::async, [&work, &chunks, i]() { work(chunks[i]); }));
+    work(chunks[0]);
+    done(chunks[0]);
+    for (size_t i = 1; i < chunks.size(); i++) {
+        pending[i - 1].get();
+        done(chunks[i]);
+    }
+}
+
+template <typename Work>
+void ForEachChunk(std::vector<ObjChunk>& chunks, Work work) {
+    ForEachChunk(chunks, work, [](const ObjChunk&) {});
+}
+
+// work(primeiro, fim) em faixas de triângulos, uma por núcleo, como ForEachChunk
+template <typename Work>
+void ForEachTriangleRange(size_t triangles, Work work) {
+    size_t ranges = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), triangles / kMinRangeTriangles));
+    std::vector<std::future<void>> pending;
+    for (size_t i = 1; i < ranges; i++) {
+        pending.push_back(std::async(std::launch::async, [&work, triangles, ranges, i]() {
+            work(triangles * i / ranges, triangles * (i + 1) / ranges);
+        }));
+    }
+    work(0, triangles / ranges);
+    for (auto& range : pending)
+        range.get();
+}
+
+// Capacidade da arena de LoadOBJ para as tabelas e para GenerateNormals, com folga de alinhamento
+size_t TableBytes(size_t positions, size_t texcoords, size_t normals, size_t corners) {
+    return positions * sizeof(glm::vec3) + texcoords * sizeof(glm::vec2) + normals * sizeof(glm::vec3) +
+           corners * sizeof(uint32_t) +
+           corners / 3 * sizeof(glm::vec3) + corners * sizeof(glm::vec3) + (positions + 1) * sizeof(uint32_t) +
+           corners * sizeof(uint32_t) + 8 * 16;
+}
+
+// Normais suaves para os cantos sem vn: cada um soma as faces em volta do mesmo v do .obj que não
+// passam de kCreaseAngle da sua, pesadas pela área e pelo ângulo do canto (uma face fina não puxa a
+// normal, nem um leque de muitas faces pequenas). Os vizinhos de cada v vêm de uma tabela CSR
+// (offsets por v, cantos em sequência); a parte cara roda em paralelo por faixas de triângulos
+void GenerateNormals(Vertex* vertices, const uint32_t* cornerPositions, size_t cornerCount, size_t positionCount,
+                     LoadArena& arena) {
+    TRACE_SCOPE("GenerateNormals");
+    size_t triangles = cornerCount / 3;
+    glm::vec3* faceNormals = arena.AllocateArray<glm::vec3>(triangles);
+    glm::vec3* weighted = arena.AllocateArray<glm::vec3>(cornerCount);
+    ForEachTriangleRange(triangles, [&](size_t first, size_t end) {
+        for (size_t t = first; t < end; t++) {
+            const Vertex* corner = &vertices[t * 3];
+            glm::vec3 cross = glm::cross(corner[1].position - corner[0].position, corner[2].position - corner[0].position);
+            float length = glm::length(cross);  // 2x a área
+            glm::vec3 normal = length > 0.0f ? cross / length : glm::vec3(0.0f);
+            faceNormals[t] = normal;
+            for (int k = 0; k < 3; k++) {
+                glm::vec3 a = corner[(k + 1) % 3].position - corner[k].position;
+                glm::vec3 b = corner[(k + 2) % 3].position - corner[k].position;
+                float lengths = glm::length(a) * glm::length(b);
+                float angle = lengths > 0.0f ? std::acos(glm::clamp(glm::dot(a, b) / lengths, -1.0f, 1.0f)) : 0.0f;
+                weighted[t * 3 + k] = normal * (length * angle);
+            }
+        }
+    });
+
+    uint32_t* offsets = arena.AllocateArray<uint32_t>(positionCount + 1);
+    uint32_t* neighbors = arena.AllocateArray<uint32_t>(cornerCount);
+    std::fill(offsets, offsets + positionCount + 1, 0u);
+    for (size_t i = 0; i < cornerCount; i++)
+        offsets[(cornerPositions[i] & ~kMissingNormal) + 1]++;
+    for (size_t p = 0; p < positionCount; p++)
+        offsets[p + 1] += offsets[p];
+    for (size_t i = 0; i < cornerCount; i++)
+        neighbors[offsets[cornerPositions[i] & ~kMissingNormal]++] = static_cast<uint32_t>(i);
+    // o preenchimento avançou cada offset até o início do v seguinte: volta uma posição
+    for (size_t p = positionCount; p > 0; p--)
+        offsets[p] = offsets[p - 1];
+    offsets[0] = 0;
+
+    float minCosine = std::cos(glm::radians(kCreaseAngle));
+    ForEachTriangleRange(triangles, [&](size_t first, size_t end) {
+        for (size_t i = first * 3; i < end * 3; i++) {
+            if (!(cornerPositions[i] & kMissingNormal))
+                continue;
+            uint32_t position = cornerPositions[i] & ~kMissingNormal;
+            const glm::vec3& face = faceNormals[i / 3];
+            glm::vec3 sum(0.0f);
+            for (uint32_t k = offsets[position]; k < offsets[position + 1]; k++) {
+                uint32_t neighbor = neighbors[k];
+                if (glm::dot(faceNormals[neighbor / 3], face) >= minCosine)
+                    sum += weighted[neighbor];
+            }
+            float length = glm::length(sum);
+            // face degenerada: fica a normal que o parser pôs
+            if (length > 0.0f)
+                vertices[i].normal = sum / length;
+        }
+    });
+}
+
+// Normal -> quadrado [-1, 1]²: projeta no octaedro e dobra o hemisfério de baixo por cima
+glm::vec2 OctahedralEncode(const glm::vec3& normal) {
+    float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (sum <= 0.0f)
+        return glm::vec2(0.0f);  // normal nula (grama, face degenerada): sai como +Z
+    glm::vec2 p(normal.x / sum, normal.y / sum);
+    if (normal.z < 0.0f) {
+        p = glm::vec2((1.0f - std::abs(p.y)) * (p.x >= 0.0f ? 1.0f : -1.0f),
+                      (1.0f - std::abs(p.x)) * (p.y >= 0.0f ? 1.0f : -1.0f));
+    }
+    return p;
+}
+
+// Vertex -> PackedVertex com a AABB do mesh (origin, extent)
+void PackVertex(const Vertex& vertex, const glm::vec3& origin, const glm::vec3& extent, PackedVertex& out) {
+    for (int k = 0; k < 3; k++) {
+        float t = extent[k] > 0.0f ? (vertex.position[k] - origin[k]) / extent[k] : 0.0f;
+        out.position[k] = static_cast<uint16_t>(std::lround(std::min(std::max(t, 0.0f), 1.0f) * 65535.0f));
+    }
+    out.position[3] = 0;
+    out.texture_coord[0] = FloatToHalf(vertex.texture_coord.x);
+    out.texture_coord[1] = FloatToHalf(vertex.texture_coord.y);
+    glm::vec2 octahedral = OctahedralEncode(vertex.normal);
+    out.normal[0] = static_cast<int16_t>(std::lround(octahedral.x * 32767.0f));
+    out.normal[1] = static_cast<int16_t>(std::lround(octahedral.y * 32767.0f));
+}
+}
+
+// Parser de .obj, se há faces que utilizam textura precisa de um "usemtl" antes da definição delas.
+// Faces de n cantos viram leques de triângulos; índices negativos contam do último v/vt/vn lido e
+// os .mtl de "mtllib" (relativos ao .obj) vão para objMaterials.
+// O arquivo inteiro e as tabelas v/vt/vn ficam numa LoadArena. Arquivos grandes são divididos em
+// pedaços (um por núcleo, de pelo menos kMinChunkBytes) cortados em fim de linha: as contagens de
+// cada pedaço dão por soma de prefixos onde ele escreve nas tabelas e em vertices, então as duas
+// passadas (v/vt/vn, depois faces) rodam em paralelo sem travas e com o resultado do serial.
+bool Mesh::LoadOBJ(const char* path) {
+    // no streaming o caminho veio de BeginStreaming: outras threads já o leem
+    if (!streaming)
+        this->path = path;
+    bool loaded = ReadOBJ(path);
+    if (streaming) {
+        // os dois antes de parserStopped: quem vê o parser parado vê o prefixo final
+        streamFailed.store(!loaded, std::memory_order_relaxed);
+        parserStopped.store(true, std::memory_order_release);
+    }
+    return loaded;
+}
+
+bool Mesh::ReadOBJ(const char* path) {
+    TRACE_SCOPE_DETAIL("LoadOBJ", path);
+    if (LoadCache()) {
+        if (streaming) {
+            layoutReady.store(true, std::memory_order_release);
+            parsedVertices.store(vertices.size(), std::memory_order_release);
+        } else {
+            ComputeUvDensity();
+        }
+        return true;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Cannot open file: " << path << std::endl;
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    size_t size = static_cast<size_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+
+    // o texto numa arena do tamanho exato; as tabelas numa segunda, dimensionada depois da contagem
+    LoadArena textArena(size + 1 + kParsePadding);
+    char* text = textArena.AllocateArray<char>(size + 1 + kParsePadding);
+    file.read(text, static_cast<std::streamsize>(size));
+    size = static_cast<size_t>(file.gcount());
+    memset(text + size, 0, 1 + kParsePadding);
+
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), size / kMinChunkBytes));
+    std::vector<ObjChunk> chunks;
+    const char* begin = text;
+    for (size_t i = 1; i <= chunkCount; i++) {
+        const char* end = i == chunkCount ? text + size
+                                          : NextLine(std::max<const char*>(begin, text + size * i / chunkCount), text + size);
+        if (end > begin)
+            chunks.emplace_back(begin, end);
+        begin = end;
+    }
+    if (chunks.empty())
+        chunks.emplace_back(text, text);
+
+    ForEachChunk(chunks, CountChunk);
+    size_t positionCount = 0, texcoordCount = 0, normalCount = 0, cornerCount = 0;
+    for (auto& chunk : chunks) {
+        chunk.positionFirst = positionCount;
+        chunk.texcoordFirst = texcoordCount;
+        chunk.normalFirst = normalCount;
+        chunk.cornerFirst = cornerCount;
+        positionCount += chunk.positions;
+        texcoordCount += chunk.texcoords;
+        normalCount += chunk.normals;
+        cornerCount += chunk.corners;
+    }
+    // cornerPositions guarda v em 31 bits e GenerateNormals indexa cantos em 32
+    if (positionCount >= kMissingNormal || cornerCount > UINT32_MAX) {
+        std::cerr << path << ": too many vertices" << std::endl;
+        return false;
+    }
+
+    std::string directory = this->path.substr(0, this->path.find_last_of('/') + 1);
+    std::vector<std::string> libraries;
+    for (const auto& chunk : chunks) {
+        for (const auto& library : chunk.libraries) {
+            libraries.push_back(directory + library);
+            LoadMaterialLibrary(libraries.back(), objMaterials);
+        }
+    }
+
+    // grupos na ordem do arquivo: cada usemtl fecha o anterior
+    for (const auto& chunk : chunks) {
+        for (const auto& material : chunk.materials) {
+            size_t first = chunk.cornerFirst + material.second;
+            if (!materialGroups.empty())
+                materialGroups.back().second.second = first - materialGroups.back().second.first;
+            std::cout << material.first << " vertice inicial = " << first << std::endl;
+            materialGroups.push_back({material.first, {first, 0}});
+        }
+    }
+    size_t vertex_count = cornerCount;
+    if (!materialGroups.empty()) {
+        materialGroups.back().second.second = vertex_count - materialGroups.back().second.first;
+    }
+    // .obj sem usemtl vira um único grupo
+    if (materialGroups.empty() && vertex_count > 0) {
+        materialGroups.push_back({"default", {0, vertex_count}});
+    }
+    lods.assign(1, {});
+    for (const auto& group : materialGroups) {
+        lods[0].push_back(group.second);
+    }
+
+    // v/vt/vn, cornerPositions e o pior caso de GenerateNormals (faceNormals, weighted, offsets,
+    // neighbors): páginas que não forem tocadas (arquivo com vn) não ocupam RAM
+    LoadArena arena(TableBytes(positionCount, texcoordCount, normalCount, cornerCount));
+    glm::vec3* temp_vertices = arena.AllocateArray<glm::vec3>(positionCount);
+    glm::vec2* temp_texcoords = arena.AllocateArray<glm::vec2>(texcoordCount);
+    glm::vec3* temp_normals = arena.AllocateArray<glm::vec3>(normalCount);
+    uint32_t* cornerPositions = arena.AllocateArray<uint32_t>(cornerCount);
+    vertices.resize(cornerCount);
+
+    ForEachChunk(chunks, [&](ObjChunk& chunk) {
+        ParseAttributes(chunk, temp_vertices, temp_texcoords, temp_normals);
+    });
+
+    if (streaming) {
+        // a AABB de todos os v (não só dos usados pelas faces) fixa a quantização antes da 1ª face
+        for (size_t i = 0; i < positionCount; i++) {
+            boundsMin = i == 0 ? temp_vertices[i] : glm::min(boundsMin, temp_vertices[i]);
+            boundsMax = i == 0 ? temp_vertices[i] : glm::max(boundsMax, temp_vertices[i]);
+        }
+        layoutReady.store(true, std::memory_order_release);
+    }
+
+    // streaming: o primeiro pedaço publica o prefixo enquanto resolve, os outros ao terminar, em ordem.
+    // Param no primeiro canto sem vn, e o último pedaço só sai depois do cache gravado
+    bool failed = false, missingNormals = false;
+    ForEachChunk(chunks, [&](ObjChunk& chunk) {
+        ParseFaces(chunk, temp_vertices, temp_texcoords, temp_normals, vertices.data(), cornerPositions,
+                   streaming && &chunk == &chunks[0] ? &parsedVertices : nullptr);
+    }, [&](const ObjChunk& chunk) {
+        failed = failed || !chunk.valid;
+        missingNormals = missingNormals || chunk.missingNormals > 0;
+        if (streaming && !failed && !missingNormals && &chunk != &chunks.back())
+            parsedVertices.store(chunk.cornerFirst + chunk.corners, std::memory_order_release);
+    });
+
+    if (failed) {
+        std::cerr << path << ": invalid face index" << std::endl;
+        // no streaming o prefixo publicado continua sendo desenhado; sem ele, nada do layout vale
+        if (!streaming) {
+            vertices.clear();
+            materialGroups.clear();
+            lods.clear();
+            objMaterials.clear();
+            boundsMin = boundsMax = glm::vec3(0.0f);
+        }
+        return false;
+    }
+    if (missingNormals)
+        GenerateNormals(vertices.data(), cornerPositions, cornerCount, positionCount, arena);
+    if (!streaming)
+        ComputeBounds();
+    SaveCache(libraries);
+    // no streaming vertices pode ser liberado pela thread de render a partir daqui
+    if (streaming)
+        parsedVertices.store(cornerCount, std::memory_order_release);
+    else
+        ComputeUvDensity();
+
+    return true;
+}
+
+void Mesh::EnableCache(const std::string& directory) {
+    mkdir(directory.c_str(), 0755);
+    struct stat info;
+    if (stat(directory.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+        std::cerr << "Cannot create mesh cache directory " << directory << std::endl;
+        return;
+    }
+    meshCacheDirectory = directory;
+}
+
+// Arquivo: magic, caminho e FileStamp do .obj, .mtl citados (caminho e FileStamp), AABB, grupos,
+// objMaterials, vertices. Qualquer diferença no .obj ou nos .mtl invalida
+bool Mesh::LoadCache() {
+    if (meshCacheDirectory.empty())
+        return false;
+    std::ifstream file(MeshCachePath(path), std::ios::binary);
+    if (!file)
+        return false;
+    TRACE_SCOPE_DETAIL("Mesh::LoadCache", path.c_str());
+
+    char magic[4];
+    std::string cachedPath;
+    FileStamp stamp;
+    file.read(magic, 4);
+    if (!file || std::string(magic, 4) != std::string(kMeshCacheMagic, 4) || !ReadString(file, cachedPath) ||
+            cachedPath != path || !ReadValue(file, stamp.size) || !ReadValue(file, stamp.mtime) ||
+            !(stamp == Stamp(path)))
+        return false;
+    uint32_t libraryCount = 0;
+    if (!ReadValue(file, libraryCount) || libraryCount > kMaxCacheString)
+        return false;
+    for (uint32_t i = 0; i < libraryCount; i++) {
+        std::string library;
+        if (!ReadString(file, library) || !ReadValue(file, stamp.size) || !ReadValue(file, stamp.mtime) ||
+                !(stamp == Stamp(library)))
+            return false;
+    }
+
+    glm::vec3 cachedMin, cachedMax;
+    uint32_t groupCount = 0, materialCount = 0;
+    uint64_t vertexCount = 0;
+    std::vector<std::pair<std::string, std::pair<size_t, size_t>>> groups;
+    std::map<std::string, ObjMaterial> materials;
+    if (!ReadValue(file, cachedMin) || !ReadValue(file, cachedMax) || !ReadValue(file, groupCount) ||
+            groupCount > kMaxCacheString)
+        return false;
+    for (uint32_t i = 0; i < groupCount; i++) {
+        std::string name;
+        uint64_t first = 0, count = 0;
+        if (!ReadString(file, name) || !ReadValue(file, first) || !ReadValue(file, count))
+            return false;
+        groups.push_back({name, {first, count}});
+    }
+    if (!ReadValue(file, materialCount) || materialCount > kMaxCacheString)
+        return false;
+    for (uint32_t i = 0; i < materialCount; i++) {
+        std::string name;
+        ObjMaterial material;
+        if (!ReadString(file, name) || !ReadValue(file, material.diffuse) || !ReadValue(file, material.specular) ||
+                !ReadValue(file, material.emission) || !ReadValue(file, material.shininess) ||
+                !ReadString(file, material.texture))
+            return false;
+        materials[name] = material;
+    }
+    // o resto do arquivo são os vértices: o tamanho confere antes de alocar
+    std::streampos start = file.tellg();
+    file.seekg(0, std::ios::end);
+    uint64_t remaining = static_cast<uint64_t>(file.tellg() - start);
+    file.seekg(start);
+    if (!ReadValue(file, vertexCount) || remaining != sizeof(vertexCount) + vertexCount * sizeof(Vertex))
+        return false;
+    for (const auto& group : groups) {
+        if (group.second.first + group.second.second > vertexCount)
+            return false;
+    }
+    std::vector<Vertex> cached(vertexCount);
+    if (!file.read(reinterpret_cast<char*>(cached.data()), vertexCount * sizeof(Vertex)))
+        return false;
+
+    vertices.swap(cached);
+    materialGroups.swap(groups);
+    objMaterials.swap(materials);
+    boundsMin = cachedMin;
+    boundsMax = cachedMax;
+    lods.assign(1, {});
+    for (const auto& group : materialGroups)
+        lods[0].push_back(group.second);
+    std::cout << path << ": " << vertices.size() / 3 << " triangles from mesh cache" << std::endl;
+    return true;
+}
+
+void Mesh::SaveCache(const std::vector<std::string>& libraries) const {
+    if (meshCacheDirectory.empty())
+        return;
+    TRACE_SCOPE_DETAIL("Mesh::SaveCache", path.c_str());
+    std::string cachePath = MeshCachePath(path);
+    // grava num temporário (um por thread: dois meshes podem vir do mesmo .obj) e renomeia:
+    // um arquivo pela metade nunca é lido
+    std::string temporary = cachePath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        FileStamp stamp = Stamp(path);
+        file.write(kMeshCacheMagic, 4);
+        WriteString(file, path);
+        WriteValue(file, stamp.size);
+        WriteValue(file, stamp.mtime);
+        WriteValue(file, static_cast<uint32_t>(libraries.size()));
+        for (const auto& library : libraries) {
+            stamp = Stamp(library);
+            WriteString(file, library);
+            WriteValue(file, stamp.size);
+            WriteValue(file, stamp.mtime);
+        }
+        WriteValue(file, boundsMin);
+        WriteValue(file, boundsMax);
+        WriteValue(file, static_cast<uint32_t>(materialGroups.size()));
+        for (const auto& group : materialGroups) {
+            WriteString(file, group.first);
+            WriteValue(file, static_cast<uint64_t>(group.second.first));
+            WriteValue(file, static_cast<uint64_t>(group.second.second));
+        }
+        WriteValue(file, static_cast<uint32_t>(objMaterials.size()));
+        for (const auto& material : objMaterials) {
+            WriteString(file, material.first);
+            WriteValue(file, material.second.diffuse);
+            WriteValue(file, material.second.specular);
+            WriteValue(file, material.second.emission);
+            WriteValue(file, material.second.shininess);
+            WriteString(file, material.second.texture);
+        }
+        WriteValue(file, static_cast<uint64_t>(vertices.size()));
+        file.write(reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(Vertex));
+        if (!file) {
+            std::cerr << "Cannot write mesh cache " << temporary << std::endl;
+            std::remove(temporary.c_str());
+            return;
+        }
+    }
+    std::rename(temporary.c_str(), cachePath.c_str());
+}
+
+void Mesh::GenerateLods() {
+    if (lods.empty() || vertices.size() / 3 < kMinLodTriangles)
+        return;
+    TRACE_SCOPE_DETAIL("Mesh::GenerateLods", path.c_str());
+    float diagonal = glm::length(boundsMax - boundsMin);
+
+    std::string report = path + ": LOD triangles " + std::to_string(TriangleCount(0));
+    while (lods.size() < kMaxLods) {
+        float tolerance = diagonal * kLodTolerance[lods.size()];
+        // cada grupo é simplificado sozinho, então o contorno entre materiais não muda. Sempre a partir do
+        // nível 0: simplificar o nível anterior somaria o erro dele ao deste
+        std::vector<std::pair<size_t, size_t>> ranges;
+        std::vector<Vertex> added;
+        for (const auto& range : lods[0]) {
+            std::vector<Vertex> simplified = SimplifyTriangles(&vertices[range.first], range.second,
+                    (range.second / 3) >> lods.size(), 4.0f * tolerance * tolerance);
+            ranges.push_back({vertices.size() + added.size(), simplified.size()});
+            added.insert(added.end(), simplified.begin(), simplified.end());
+        }
+
+        // quase tudo preso em bordas/costuras ou acima do erro: o nível não compensa
+        if (added.size() / 3 * 10 > TriangleCount(lods.size() - 1) * 8)
+            break;
+        vertices.insert(vertices.end(), added.begin(), added.end());
+        lods.push_back(ranges);
+        report += " / " + std::to_string(added.size() / 3);
+    }
+    std::cout << report << std::endl;
+}
+
+void Mesh::GenerateOccluder() {
+    TRACE_SCOPE_DETAIL("Mesh::GenerateOccluder", path.c_str());
+    // só posição: costuras de uv e limites de material não importam para a profundidade
+    std::vector<Vertex> positions;
+    positions.reserve(TriangleCount(0) * 3);
+    for (const auto& range : lods[0]) {
+        for (size_t i = range.first; i < range.first + range.second; i++) {
+            Vertex vertex{};
+            vertex.position = vertices[i].position;
+            positions.push_back(vertex);
+        }
+    }
+
+    float tolerance = glm::length(boundsMax - boundsMin) * kOccluderTolerance;
+    // inside: o proxy não pode cobrir pixels que o modelo não cobre, senão esconderia objetos visíveis
+    std::vector<Vertex> simplified = SimplifyTriangles(positions.data(), positions.size(), kOccluderTriangles,
+            tolerance * tolerance, true);
+    occluder.resize(simplified.size());
+    for (size_t i = 0; i < simplified.size(); i++) {
+        occluder[i] = simplified[i].position;
+    }
+    std::cout << path << ": occluder triangles " << occluder.size() / 3 << std::endl;
+}
+
+size_t Mesh::TriangleCount(size_t lod) const {
+    size_t count = 0;
+    for (const auto& range : lods[lod]) {
+        count += range.second;
+    }
+    return count / 3;
+}
+
+void Mesh::Upload(bool packed) {
+    TRACE_SCOPE_DETAIL("Mesh::Upload", path.c_str());
+    CreateBuffers(packed);
+    if (packed)
+        UploadPacked();
+    else
+        UploadFloat();
+    SetupAttributes();
+    residentVertices = vertices.size();
+}
+
+void Mesh::CreateBuffers(bool packed) {
+    this->packed = packed;
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glGenVertexArrays(1, &depthVao);
+    glGenBuffers(1, &positionVbo);
+}
+
+void Mesh::SetupAttributes() {
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    if (packed) {
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, position));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, texture_coord));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, normal));
+    } else {
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texture_coord));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+    }
+
+    // Stream separado só com posições: o pre-pass lê 12 bytes por vértice em vez de 32
+    // (compacto: as mesmas posições quantizadas, por causa do GL_EQUAL, em 8 bytes)
+    glBindVertexArray(depthVao);
+    glBindBuffer(GL_ARRAY_BUFFER, positionVbo);
+    glEnableVertexAttribArray(0);
+    if (packed)
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, 4 * sizeof(uint16_t), (void*)0);
+    else
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+}
+
+void Mesh::UploadFloat() {
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+
+    std::vector<glm::vec3> positions(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        positions[i] = vertices[i].position;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, positionVbo);
+    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), positions.data(), GL_STATIC_DRAW);
+    gpuBytes = vertices.size() * (sizeof(Vertex) + sizeof(glm::vec3));
+}
+
+void Mesh::UploadPacked() {
+    std::vector<PackedVertex> packedVertices(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        PackVertex(vertices[i], boundsMin, boundsMax - boundsMin, packedVertices[i]);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, packedVertices.size() * sizeof(PackedVertex), packedVertices.data(), GL_STATIC_DRAW);
+
+    std::vector<uint16_t> positions(vertices.size() * 4);
+    for (size_t i = 0; i < vertices.size(); i++) {
+        memcpy(&positions[i * 4], packedVertices[i].position, sizeof(packedVertices[i].position));
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, positionVbo);
+    glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(uint16_t), positions.data(), GL_STATIC_DRAW);
+    gpuBytes = vertices.size() * (sizeof(PackedVertex) + 4 * sizeof(uint16_t));
+}
+
+// Os buffers têm o tamanho final desde o layout; cada frame mapeia só o trecho novo, que nenhum
+// desenho lê ainda, então GL_MAP_UNSYNCHRONIZED_BIT não espera a GPU
+bool Mesh::UploadStreamed(bool packed, size_t budgetBytes) {
+    if (!layoutReady.load(std::memory_order_acquire))
+        return parserStopped.load(std::memory_order_acquire);  // falhou antes do layout: não há o que enviar
+    if (!vao)
+        CreateBuffers(packed);
+    size_t total = vertices.size();
+    size_t vertexSize = this->packed ? sizeof(PackedVertex) : sizeof(Vertex);
+    size_t positionSize = this->packed ? 4 * sizeof(uint16_t) : sizeof(glm::vec3);
+    if (gpuBytes == 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, total * vertexSize, NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, positionVbo);
+        glBufferData(GL_ARRAY_BUFFER, total * positionSize, NULL, GL_STATIC_DRAW);
+        SetupAttributes();
+        gpuBytes = total * (vertexSize + positionSize);
+    }
+
+    // triângulos inteiros; o parser sempre publica múltiplos de 3
+    size_t budget = std::max<size_t>(budgetBytes / (vertexSize + positionSize) / 3 * 3, 3);
+    // parserStopped antes de parsedVertices: se o parser já parou, o prefixo lido é o final
+    bool stopped = parserStopped.load(std::memory_order_acquire);
+    size_t count = std::min(parsedVertices.load(std::memory_order_acquire) - residentVertices, budget);
+    if (count == 0)
+        return FinishStreamed(stopped, total);
+
+    TRACE_SCOPE_DETAIL("Mesh::UploadStreamed", path.c_str());
+    const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    const Vertex* source = &vertices[residentVertices];
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    void* mapped = glMapBufferRange(GL_ARRAY_BUFFER, residentVertices * vertexSize, count * vertexSize, access);
+    glBindBuffer(GL_ARRAY_BUFFER, positionVbo);
+    void* mappedPositions = glMapBufferRange(GL_ARRAY_BUFFER, residentVertices * positionSize, count * positionSize, access);
+    if (mapped && mappedPositions) {
+        if (this->packed) {
+            PackedVertex* out = static_cast<PackedVertex*>(mapped);
+            uint16_t* outPositions = static_cast<uint16_t*>(mappedPositions);
+            for (size_t i = 0; i < count; i++) {
+                PackVertex(source[i], boundsMin, boundsMax - boundsMin, out[i]);
+                memcpy(&outPositions[i * 4], out[i].position, sizeof(out[i].position));
+            }
+        } else {
+            memcpy(mapped, source, count * sizeof(Vertex));
+            glm::vec3* outPositions = static_cast<glm::vec3*>(mappedPositions);
+            for (size_t i = 0; i < count; i++) {
+                outPositions[i] = source[i].position;
+            }
+        }
+    }
+    // glUnmapBuffer falso: o conteúdo se perdeu (troca de modo de vídeo); o trecho vai de novo
+    bool written = mapped && mappedPositions;
+    if (mappedPositions && !glUnmapBuffer(GL_ARRAY_BUFFER))
+        written = false;
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    if (mapped && !glUnmapBuffer(GL_ARRAY_BUFFER))
+        written = false;
+    if (written)
+        residentVertices += count;
+    return FinishStreamed(stopped && residentVertices == parsedVertices.load(std::memory_order_acquire), total);
+}
+
+bool Mesh::FinishStreamed(bool stopped, size_t total) {
+    if (residentVertices == total) {
+        ComputeUvDensity();
+        return true;
+    }
+    // parser parou com erro e o prefixo publicado já está na GPU: ele é o mesh (sem uvDensity)
+    return stopped;
+}
+
+void Mesh::ReleaseCpuData(CpuResidency residency) {
+    if (residency == CpuResidency::Full)
+        return;
+    if (residency == CpuResidency::Positions && !lods.empty()) {
+        // streaming interrompido: só o prefixo enviado tem vértices
+        size_t limit = streaming ? residentVertices : vertices.size();
+        positions.clear();
+        positions.reserve(TriangleCount(0) * 3);
+        for (const auto& range : lods[0]) {
+            for (size_t i = range.first; i < std::min(range.first + range.second, limit); i++) {
+                positions.push_back(vertices[i].position);
+            }
+        }
+    }
+    // swap: clear() manteria a capacidade alocada
+    std::vector<Vertex>().swap(vertices);
+}
+
+size_t Mesh::CpuBytes() const {
+    if (!LayoutReady())
+        return 0;  // streaming: o parser ainda está dimensionando vertices
+    return vertices.capacity() * sizeof(Vertex) + positions.capacity() * sizeof(glm::vec3) +
+           occluder.capacity() * sizeof(glm::vec3);
+}
+
+void Mesh::BindDecode(GLuint program) const {
+    glm::vec3 offset = packed ? boundsMin : glm::vec3(0.0f);
+    glm::vec3 scale = packed ? boundsMax - boundsMin : glm::vec3(1.0f);
+    glUniform3fv(glGetUniformLocation(program, "positionOffset"), 1, &offset.x);
+    glUniform3fv(glGetUniformLocation(program, "positionScale"), 1, &scale.x);
+    glUniform1i(glGetUniformLocation(program, "packedNormals"), packed);
+}
+
+void Mesh::ComputeBounds() {
+    if (vertices.empty())
+        return;
+
+    boundsMin = boundsMax = vertices[0].position;
+    for (const auto& vertex : vertices) {
+        boundsMin = glm::min(boundsMin, vertex.position);
+        boundsMax = glm::max(boundsMax, vertex.position);
+    }
+}
+
+// Só o nível 0: os LODs mantêm o mapeamento. Triângulos degenerados em uv ou no espaço não pesam
+void Mesh::ComputeUvDensity() {
+    uvDensity.assign(lods.empty() ? 0 : lods[0].size(), 0.0f);
+    for (size_t group = 0; group < uvDensity.size(); group++) {
+        double uvArea = 0.0, area = 0.0;
+        const auto& range = lods[0][group];
+        for (size_t i = range.first; i + 2 < range.first + range.second; i += 3) {
+            const Vertex& a = vertices[i];
+            const Vertex& b = vertices[i + 1];
+            const Vertex& c = vertices[i + 2];
+            glm::vec2 du = b.texture_coord - a.texture_coord, dv = c.texture_coord - a.texture_coord;
+            uvArea += 0.5 * std::abs(du.x * dv.y - du.y * dv.x);
+            area += 0.5 * glm::length(glm::cross(b.position - a.position, c.position - a.position));
+        }
+        if (uvArea > 0.0 && area > 0.0)
+            uvDensity[group] = static_cast<float>(std::sqrt(uvArea / area));
+    }
+}
+
+float Mesh::UvDensity(size_t group) const {
+    if (group < uvDensity.size() && uvDensity[group] > 0.0f)
+        return uvDensity[group];
+    float diagonal = glm::length(boundsMax - boundsMin);
+    return diagonal > 0.0f ? 1.0f / diagonal : 1.0f;
+}
+
+Mesh::~Mesh() {
+    if (vao) glDeleteVertexArrays(1, &vao);
+    if (vbo) glDeleteBuffers(1, &vbo);
+    if (depthVao) glDeleteVertexArrays(1, &depthVao);
+    if (positionVbo) glDeleteBuffers(1, &positionVbo);
+}
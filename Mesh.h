@@ -0,0 +1,143 @@
+// Mesh.h
+#ifndef MESH_H
+#define MESH_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include <string>
+
+struct Vertex {
+    glm::vec3 position;
+    glm::vec2 texture_coord;
+    glm::vec3 normal;
+};
+
+// Vertex compacto na GPU (16 bytes em vez de 32). vs.glsl/depth_vs.glsl desfazem com Mesh::BindDecode
+struct PackedVertex {
+    uint16_t position[4];       // unorm16 dentro da AABB do mesh; [3] só completa 8 bytes
+    uint16_t texture_coord[2];  // half float (as uvs dos modelos ficam em [0, 1])
+    int16_t normal[2];          // octaédrica, snorm16
+};
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex sem padding");
+
+// Material de um .mtl (mtllib do .obj), usado pelas instâncias da cena que não listam "materials".
+// Sem a linha correspondente no .mtl, fica o padrão de MaterialProperties
+struct ObjMaterial {
+    glm::vec3 diffuse{1.0f};   // Kd
+    glm::vec3 specular{1.0f};  // Ks
+    glm::vec3 emission{0.0f};  // Ke
+    float shininess{32.0f};    // Ns
+    std::string texture;       // map_Kd, já com o diretório do .mtl
+};
+
+// O que fica na RAM depois do Upload (Mesh::ReleaseCpuData)
+enum class CpuResidency {
+    None,       // só o que o desenho usa (grupos, LODs, AABB, proxy de oclusão)
+    Positions,  // mais as posições do nível 0, para picking/colisão
+    Full        // vertices inteiro, como antes do Upload
+};
+
+// Geometria de um .obj, compartilhada entre todas as instâncias que usam o mesmo arquivo.
+// LoadOBJ e GenerateLods só usam CPU (podem rodar em outra thread); Upload precisa do contexto GL.
+// Depois do Upload, ReleaseCpuData libera a cópia da CPU conforme a CpuResidency.
+// Streaming (BeginStreaming(path) antes de LoadOBJ, que roda numa thread de carga enquanto a cena já é
+// desenhada): LoadOBJ publica o layout (grupos, lods[0], AABB de todos os v, tamanho de vertices)
+// antes de resolver as faces e depois o prefixo de vertices já pronto; a thread de render chama
+// UploadStreamed a cada frame e os desenhos param em ResidentVertices. Sem LODs nem proxy de oclusão.
+// Se o parser falha no meio, o prefixo já publicado é o mesh final (StreamFailed).
+// Cantos de face sem vn ganham normais suaves (ponderadas por área e ângulo, com ângulo de aresta
+// viva) depois de todas as faces. Com EnableCache, o resultado de LoadOBJ vai para um binário por
+// .obj e a próxima carga só o lê, enquanto o .obj e os .mtl não mudarem.
+class Mesh {
+public:
+    static const size_t kMaxLods = 4;  // nível 0 é o .obj original
+
+    std::string path;
+    std::vector<Vertex> vertices;
+    // nome do material -> (vértice inicial, quantidade de vértices)
+    std::vector<std::pair<std::string, std::pair<size_t, size_t>>> materialGroups;
+    // materiais dos .mtl citados em mtllib, por nome (vazio se o .obj não tem mtllib ou o arquivo falta)
+    std::map<std::string, ObjMaterial> objMaterials;
+    // lods[nível][grupo] = (vértice inicial, quantidade); os níveis > 0 ficam depois do original em vertices
+    std::vector<std::vector<std::pair<size_t, size_t>>> lods;
+    glm::vec3 boundsMin{0.0f}, boundsMax{0.0f};  // AABB em coordenadas do modelo
+    // Proxy de oclusão (GenerateOccluder): sopa de triângulos só com posições; vazio se não é oclusor
+    std::vector<glm::vec3> occluder;
+    // Triângulos do nível 0 só com posição, mantidos por ReleaseCpuData(CpuResidency::Positions)
+    std::vector<glm::vec3> positions;
+    // Por grupo: unidades de uv por unidade do modelo (raiz da razão entre as áreas), para o streaming de texturas
+    std::vector<float> uvDensity;
+
+    Mesh() = default;
+    ~Mesh();
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
+    // Diretório do cache de LoadOBJ; chamar antes de qualquer carga
+    static void EnableCache(const std::string& directory);
+
+    bool LoadOBJ(const char* path);
+    // Cada nível com ~metade dos triângulos do anterior, grupo a grupo (bordas dos grupos preservadas);
+    // todos simplificados do nível 0, com o erro de cada um medido contra o original
+    void GenerateLods();
+    // Malha inteira bem simplificada, para o rasterizador de oclusão da CPU (SoftwareOcclusion)
+    void GenerateOccluder();
+    // packed: PackedVertex (padrão); senão Vertex como está na CPU
+    void Upload(bool packed = true);
+    // uniforms positionOffset/positionScale/packedNormals de vs.glsl e depth_vs.glsl
+    void BindDecode(GLuint program) const;
+    void ReleaseCpuData(CpuResidency residency);
+    size_t CpuBytes() const;
+    size_t GpuBytes() const { return gpuBytes; }  // VBO principal + stream de posições
+    size_t LodCount() const { return lods.empty() ? 1 : lods.size(); }
+    size_t TriangleCount(size_t lod) const;
+    // uvDensity do grupo; sem ela (streaming incompleto, grupo sem uvs) a textura cobre a AABB uma vez
+    float UvDensity(size_t group) const;
+    // Streaming: chamar antes de LoadOBJ, na thread que cria os objetos; path vale desde já (LoadOBJ
+    // roda em outra thread e não o escreve mais)
+    void BeginStreaming(const std::string& path) {
+        this->path = path;
+        streaming = true;
+    }
+    bool Streaming() const { return streaming; }
+    // Grupos, lods e AABB já valem (sempre, sem streaming); qualquer thread
+    bool LayoutReady() const { return !streaming || layoutReady.load(std::memory_order_acquire); }
+    // Thread de render: envia até budgetBytes do prefixo pronto; true quando o parser terminou e tudo o
+    // que ele publicou está na GPU (vertices pode ser liberado)
+    bool UploadStreamed(bool packed, size_t budgetBytes);
+    // Streaming: LoadOBJ terminou com erro; vale depois de UploadStreamed devolver true
+    bool StreamFailed() const { return streamFailed.load(std::memory_order_acquire); }
+    // Vértices já na GPU; os desenhos não passam disso
+    size_t ResidentVertices() const { return residentVertices; }
+    GLuint GetVAO() const { return vao; }
+    GLuint GetDepthVAO() const { return depthVao; }  // só posições, para o depth pre-pass
+
+private:
+    GLuint vao{0}, vbo{0};
+    GLuint depthVao{0}, positionVbo{0};
+    bool packed{false};
+    size_t gpuBytes{0};
+    size_t residentVertices{0};
+    bool streaming{false};
+    std::atomic<bool> layoutReady{false};
+    std::atomic<size_t> parsedVertices{0};  // prefixo de vertices escrito pelo parser
+    std::atomic<bool> parserStopped{false};  // LoadOBJ retornou; parsedVertices não muda mais
+    std::atomic<bool> streamFailed{false};
+
+    bool ReadOBJ(const char* path);
+    void ComputeBounds();
+    void ComputeUvDensity();
+    bool LoadCache();
+    void SaveCache(const std::vector<std::string>& libraries) const;
+    void CreateBuffers(bool packed);
+    bool FinishStreamed(bool stopped, size_t total);
+    void SetupAttributes();
+    void UploadFloat();
+    void UploadPacked();
+};
+
+#endif
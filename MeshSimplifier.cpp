@@ -0,0 +1,287 @@
+// MeshSimplifier.cpp
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
+namespace {
+
+// Solda por posição + uv (os 5 primeiros floats); a normal fica em cada canto do triângulo
+const size_t kWeldBytes = offsetof(Vertex, normal);
+static_assert(kWeldBytes == 5 * sizeof(float), "Vertex: posição e uv contíguas no início");
+
+struct VertexHash {
+    size_t operator()(const Vertex& v) const {
+        uint32_t bits[5];
+        memcpy(bits, &v, sizeof(bits));
+        uint32_t hash = 2166136261u;
+        for (uint32_t word : bits)
+            hash = (hash ^ word) * 16777619u;
+        return hash;
+    }
+};
+
+struct VertexEqual {
+    bool operator()(const Vertex& a, const Vertex& b) const { return memcmp(&a, &b, kWeldBytes) == 0; }
+};
+
+// Matriz 4x4 simétrica da soma dos planos (n, d): erro(p) = soma de (n·p + d)²
+struct Quadric {
+    double a00{0}, a01{0}, a02{0}, a03{0}, a11{0}, a12{0}, a13{0}, a22{0}, a23{0}, a33{0};
+
+    void AddPlane(double x, double y, double z, double d) {
+        a00 += x * x; a01 += x * y; a02 += x * z; a03 += x * d;
+        a11 += y * y; a12 += y * z; a13 += y * d;
+        a22 += z * z; a23 += z * d;
+        a33 += d * d;
+    }
+
+    Quadric& operator+=(const Quadric& q) {
+        a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+        a11 += q.a11; a12 += q.a12; a13 += q.a13;
+        a22 += q.a22; a23 += q.a23;
+        a33 += q.a33;
+        return *this;
+    }
+
+    double Error(const glm::vec3& p) const {
+        double x = p.x, y = p.y, z = p.z;
+        return a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + 2.0 * a03 * x
+             + a11 * y * y + 2.0 * a12 * y * z + 2.0 * a13 * y
+             + a22 * z * z + 2.0 * a23 * z
+             + a33;
+    }
+};
+
+// Colapso de meia aresta: "from" some e seus triângulos passam a usar "to" (que não se move)
+struct Candidate {
+    double cost;
+    uint32_t from, to;
+    unsigned fromVersion, toVersion;
+
+    bool operator>(const Candidate& other) const { return cost > other.cost; }
+};
+
+uint64_t EdgeKey(uint32_t a, uint32_t b) {
+    return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+
+} // namespace
+
+std::vector<Vertex> SimplifyTriangles(const Vertex* input, size_t count, size_t targetTriangles, float maxError,
+                                      bool inside) {
+    // Solda: a topologia vem dos índices, então costuras de uv viram bordas. Quinas de normal
+    // não: a quádrica já encarece colapsar através delas, e cada canto guarda a sua normal
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices(count);
+    std::vector<glm::vec3> cornerNormals(count);
+    std::unordered_map<Vertex, uint32_t, VertexHash, VertexEqual> unique;
+    for (size_t i = 0; i < count; i++) {
+        auto inserted = unique.emplace(input[i], static_cast<uint32_t>(vertices.size()));
+        if (inserted.second)
+            vertices.push_back(input[i]);
+        indices[i] = inserted.first->second;
+        cornerNormals[i] = input[i].normal;
+    }
+
+    size_t triangleCount = count / 3;
+    size_t alive = triangleCount;
+    std::vector<bool> removed(triangleCount, false);
+    std::vector<std::vector<uint32_t>> adjacency(vertices.size());  // triângulos de cada vértice
+    std::vector<Quadric> quadrics(vertices.size());
+    std::unordered_map<uint64_t, int> edgeUse;
+    size_t flatTriangles = 0;
+    double volume = 0.0;  // 6x o volume com sinal: negativo se o winding aponta para dentro
+
+    for (size_t t = 0; t < triangleCount; t++) {
+        uint32_t* tri = &indices[t * 3];
+        const glm::vec3* normals = &cornerNormals[t * 3];
+        if (memcmp(&normals[0], &normals[1], sizeof(glm::vec3)) == 0 &&
+            memcmp(&normals[0], &normals[2], sizeof(glm::vec3)) == 0)
+            flatTriangles++;
+        if (tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2]) {
+            removed[t] = true;
+            alive--;
+            continue;
+        }
+
+        const glm::vec3& p0 = vertices[tri[0]].position;
+        glm::vec3 n = glm::cross(vertices[tri[1]].position - p0, vertices[tri[2]].position - p0);
+        volume += glm::dot(p0, glm::cross(vertices[tri[1]].position, vertices[tri[2]].position));
+        float length = glm::length(n);
+        for (int k = 0; k < 3; k++) {
+            if (length > 0.0f) {
+                glm::vec3 unit = n / length;
+                quadrics[tri[k]].AddPlane(unit.x, unit.y, unit.z, -glm::dot(unit, p0));
+            }
+            adjacency[tri[k]].push_back(static_cast<uint32_t>(t));
+            edgeUse[EdgeKey(tri[k], tri[(k + 1) % 3])]++;
+        }
+    }
+
+    // Aresta de borda (1 triângulo) ou não-manifold (3+): as pontas não se movem
+    std::vector<bool> locked(vertices.size(), false);
+    for (const auto& edge : edgeUse) {
+        if (edge.second != 2) {
+            locked[edge.first >> 32] = true;
+            locked[edge.first & 0xffffffffu] = true;
+        }
+    }
+
+    std::vector<unsigned> version(vertices.size(), 0);
+    std::vector<bool> collapsed(vertices.size(), false);
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> heap;
+
+    auto push = [&](uint32_t from, uint32_t to) {
+        if (locked[from])
+            return;
+        Quadric q = quadrics[from];
+        q += quadrics[to];
+        heap.push({q.Error(vertices[to].position), from, to, version[from], version[to]});
+    };
+    for (const auto& edge : edgeUse) {
+        uint32_t a = static_cast<uint32_t>(edge.first >> 32), b = static_cast<uint32_t>(edge.first & 0xffffffffu);
+        push(a, b);
+        push(b, a);
+    }
+
+    auto neighbors = [&](uint32_t v, std::vector<uint32_t>& out) {
+        out.clear();
+        for (uint32_t t : adjacency[v]) {
+            if (removed[t])
+                continue;
+            for (int k = 0; k < 3; k++) {
+                uint32_t n = indices[t * 3 + k];
+                if (n != v && std::find(out.begin(), out.end(), n) == out.end())
+                    out.push_back(n);
+            }
+        }
+    };
+
+    float outward = volume < 0.0 ? -1.0f : 1.0f;
+    std::vector<uint32_t> fromRing, toRing;
+    std::vector<glm::vec3> toNormals;
+    auto canCollapse = [&](uint32_t from, uint32_t to) {
+        // Condição de link: mais de 2 vizinhos em comum fecharia um túnel (vira não-manifold)
+        neighbors(from, fromRing);
+        neighbors(to, toRing);
+        int common = 0;
+        for (uint32_t n : fromRing) {
+            if (std::find(toRing.begin(), toRing.end(), n) != toRing.end())
+                common++;
+        }
+        if (common > 2)
+            return false;
+
+        // Nenhum triângulo restante pode virar do avesso nem degenerar
+        const glm::vec3& target = vertices[to].position;
+        glm::vec3 move = target - vertices[from].position;
+        for (uint32_t t : adjacency[from]) {
+            if (removed[t])
+                continue;
+            const uint32_t* tri = &indices[t * 3];
+            if (tri[0] == to || tri[1] == to || tri[2] == to)
+                continue;
+
+            glm::vec3 p[3], q[3];
+            for (int k = 0; k < 3; k++) {
+                p[k] = vertices[tri[k]].position;
+                q[k] = tri[k] == from ? target : p[k];
+            }
+            glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+            glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+            float afterLength = glm::length(after);
+            if (afterLength <= 0.0f || glm::dot(before, after) < 0.2f * glm::length(before) * afterLength)
+                return false;
+            // inside: o destino não pode ficar na frente do plano de nenhum triângulo em volta de "from"
+            // (a folga absorve o arredondamento em regiões planas)
+            if (inside && outward * glm::dot(before, move) > 1e-4f * glm::length(before) * glm::length(move))
+                return false;
+        }
+        return true;
+    };
+
+    while (alive > targetTriangles && !heap.empty()) {
+        Candidate candidate = heap.top();
+        heap.pop();
+        if (candidate.cost > maxError)
+            break;
+
+        uint32_t from = candidate.from, to = candidate.to;
+        if (collapsed[from] || collapsed[to] || candidate.fromVersion != version[from] ||
+            candidate.toVersion != version[to])
+            continue;  // entrada velha: um dos vértices mudou depois de entrar na fila
+        if (!canCollapse(from, to))
+            continue;
+
+        // normais que "to" já tem; cada canto movido fica com a mais parecida com a sua (respeita quinas)
+        toNormals.clear();
+        for (uint32_t t : adjacency[to]) {
+            for (int k = 0; !removed[t] && k < 3; k++) {
+                if (indices[t * 3 + k] == to)
+                    toNormals.push_back(cornerNormals[t * 3 + k]);
+            }
+        }
+
+        for (uint32_t t : adjacency[from]) {
+            if (removed[t])
+                continue;
+            uint32_t* tri = &indices[t * 3];
+            if (tri[0] == to || tri[1] == to || tri[2] == to) {
+                removed[t] = true;
+                alive--;
+                continue;
+            }
+            for (int k = 0; k < 3; k++) {
+                if (tri[k] != from)
+                    continue;
+                tri[k] = to;
+                glm::vec3& normal = cornerNormals[t * 3 + k];
+                glm::vec3 best = toNormals.empty() ? normal : toNormals[0];
+                for (const glm::vec3& candidateNormal : toNormals) {
+                    if (glm::dot(candidateNormal, normal) > glm::dot(best, normal))
+                        best = candidateNormal;
+                }
+                normal = best;
+            }
+            adjacency[to].push_back(t);
+        }
+        collapsed[from] = true;
+        adjacency[from].clear();
+        quadrics[to] += quadrics[from];
+        version[to]++;
+
+        std::vector<uint32_t>& ring = adjacency[to];
+        ring.erase(std::remove_if(ring.begin(), ring.end(), [&](uint32_t t) { return removed[t]; }), ring.end());
+
+        // custos dos vizinhos de "to" mudaram junto com a quádrica dele
+        neighbors(to, toRing);
+        for (uint32_t n : toRing) {
+            push(n, to);
+            push(to, n);
+        }
+    }
+
+    // Malha facetada (normal de face em todos os cantos): recalcula a face com as posições novas
+    bool flat = flatTriangles * 10 >= triangleCount * 9;
+    std::vector<Vertex> result;
+    result.reserve(alive * 3);
+    for (size_t t = 0; t < triangleCount; t++) {
+        if (removed[t])
+            continue;
+        const uint32_t* tri = &indices[t * 3];
+        glm::vec3 face = glm::cross(vertices[tri[1]].position - vertices[tri[0]].position,
+                                    vertices[tri[2]].position - vertices[tri[0]].position);
+        float faceLength = glm::length(face);
+        for (int k = 0; k < 3; k++) {
+            Vertex vertex = vertices[tri[k]];
+            vertex.normal = flat && faceLength > 0.0f ? face / faceLength : cornerNormals[t * 3 + k];
+            result.push_back(vertex);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,20 @@
+// MeshSimplifier.h
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <cstddef>
+#include <vector>
+#include "Mesh.h"
+
+// Simplificação por colapso de arestas com erro quádrico (Garland-Heckbert), só CPU.
+// Recebe uma sopa de triângulos (3 vértices por triângulo, como Mesh::vertices) e devolve outra
+// com no máximo targetTriangles, parando antes se o próximo colapso passar de maxError
+// (soma das distâncias² aos planos originais, em unidades do modelo).
+// Vértices com a mesma posição e uv são soldados; vértices em bordas ficam presos, o que
+// preserva o contorno do grupo de material e as costuras de textura.
+// inside: só aceita colapsos que deixam a superfície atrás da anterior (o resultado fica dentro do
+// original e a silhueta não cresce); o lado de fora vem do winding, pelo sinal do volume.
+std::vector<Vertex> SimplifyTriangles(const Vertex* vertices, size_t count, size_t targetTriangles, float maxError,
+                                      bool inside = false);
+
+#endif
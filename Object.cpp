@@ -1,222 +1,143 @@
 
 #include "Object.h"
-#include <fstream>
-#include <sstream>
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+#include "Tracer.h"
 
-Object::Object(GLuint shaderProgram, const char* objPath, 
-               const std::vector<const char*>& texturePaths,
+namespace {
+// Tamanho projetado abaixo do qual cada nível entra (índice = nível); a histerese é a folga
+// em volta do limiar para não alternar de nível a cada frame com a câmera parada na fronteira
+const float kLodScreenSize[Mesh::kMaxLods] = {0.0f, 0.35f, 0.15f, 0.06f};
+const float kLodHysteresis = 0.15f;
+}
+
+Object::Object(std::shared_ptr<Mesh> mesh,
+               const std::vector<GLuint>& textures,
                const std::vector<MaterialProperties>& matProperties,
                float _xPos, float _yPos, float _zPos, float _scale, float _angle, int axis)
-    : shaderProgram(shaderProgram), xPos(_xPos), yPos(_yPos), zPos(_zPos),
-      scale(_scale), angle(_angle), axis(axis), name(objPath), materials(matProperties) {
-    
-    if (!LoadOBJ(objPath)) {
-        throw std::runtime_error("Failed to load OBJ file!");
+    : name(mesh->path), materials(matProperties), xPos(_xPos), yPos(_yPos), zPos(_zPos),
+      scale(_scale), angle(_angle), mesh(mesh), textures(textures), axis(axis) {
+
+    // Draw indexa materials/textures por grupo do .obj
+    if (mesh->LayoutReady() && !MaterialsCoverGroups()) {
+        throw std::runtime_error(name + ": " + std::to_string(mesh->materialGroups.size()) +
+                " material groups but " + std::to_string(materials.size()) + " materials/" +
+                std::to_string(this->textures.size()) + " textures");
     }
 
-    model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(xPos, yPos, zPos));
-    
-    glm::vec3 rotation_axis(0.0f, 1.0f, 0.0f);
-    if (axis == 0) rotation_axis = glm::vec3(1.0f, 0.0f, 0.0f);
-    if (axis == 2) rotation_axis = glm::vec3(0.0f, 0.0f, 1.0f);
-    
-    model = glm::rotate(model, angle, rotation_axis);
-    model = glm::scale(model, glm::vec3(scale));
+    GetModelMatrix();
+}
 
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
+bool Object::MaterialsCoverGroups() const {
+    return materials.size() >= mesh->materialGroups.size() && textures.size() >= mesh->materialGroups.size();
+}
 
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+bool Object::Drawable() {
+    if (drawable || mismatched || !mesh->LayoutReady())
+        return drawable;
+    if (!MaterialsCoverGroups()) {
+        std::cerr << name << ": " << mesh->materialGroups.size() << " material groups but " << materials.size()
+                  << " materials/" << textures.size() << " textures (not drawn)" << std::endl;
+        mismatched = true;
+        return false;
+    }
+    drawable = true;
+    return true;
+}
 
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
+void Object::Draw(GLuint shaderProgram, const glm::mat4& modelMatrix, const std::vector<MaterialProperties>& frameMaterials,
+                  size_t lod) {
+    TRACE_SCOPE_DETAIL("Object::Draw", name.c_str());
+    glUseProgram(shaderProgram);
+    SetModel(shaderProgram, modelMatrix);
+    for (size_t i = 0; i < mesh->materialGroups.size(); i++) {
+        DrawGroup(shaderProgram, i, frameMaterials[i], lod);
+    }
+}
 
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texture_coord));
+void Object::SetModel(GLuint shaderProgram, const glm::mat4& modelMatrix) const {
+    GLint loc_model = glGetUniformLocation(shaderProgram, "model");
+    glUniformMatrix4fv(loc_model, 1, GL_FALSE, glm::value_ptr(modelMatrix));
+    mesh->BindDecode(shaderProgram);
+}
 
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+void Object::DrawGroup(GLuint shaderProgram, size_t group, const MaterialProperties& mat, size_t lod) const {
+    glBindVertexArray(mesh->GetVAO());
+    ApplyMaterial(shaderProgram, mat, textures[group]);
 
-    textures.resize(texturePaths.size());
-    for (size_t i = 0; i < texturePaths.size(); i++) {
-        if (!LoadTexture(texturePaths[i], textures[i])) {
-            throw std::runtime_error("Failed to load texture: " + std::string(texturePaths[i]));
-        }
-    }
+    // streaming: só o que já está na GPU
+    const auto& range = mesh->lods[lod][group];
+    size_t end = std::min(range.first + range.second, mesh->ResidentVertices());
+    if (end > range.first)
+        glDrawArrays(GL_TRIANGLES, range.first, end - range.first);
 }
 
-// Parser de .obj, se há faces que utilizam textura precisa de um "usemtl" antes da definição delas 
-bool Object::LoadOBJ(const char* path) {
-    std::vector<glm::vec3> temp_vertices;
-    std::vector<glm::vec2> temp_texcoords;
-    std::vector<glm::vec3> temp_normals;
-    std::string current_material;
-    size_t vertex_count = 0;
+void ApplyMaterial(GLuint shaderProgram, const MaterialProperties& mat, GLuint texture) {
+    GLint emissionLoc = glGetUniformLocation(shaderProgram, "material.emission");
+    GLint shininessLoc = glGetUniformLocation(shaderProgram, "material.shininess");
+    GLint isLightSourceLoc = glGetUniformLocation(shaderProgram, "material.isLightSource");
+    GLint diffuseReflectionLoc = glGetUniformLocation(shaderProgram, "material.diffuseReflection");
+    GLint specularReflectionLoc = glGetUniformLocation(shaderProgram, "material.specularReflection");
 
-    std::ifstream file(path);
-    if (!file) {
-        std::cerr << "Cannot open file: " << path << std::endl;
-        return false;
-    }
-
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string type;
-        iss >> type;
+    // fonte de luz apagada brilha 0.1; o shader só multiplica pela emissão
+    glm::vec3 emission = mat.isLightSource && !mat.isActive ? glm::vec3(0.1f) : mat.emission;
+    glUniform3fv(emissionLoc, 1, glm::value_ptr(emission));
+    glUniform1f(shininessLoc, mat.shininess);
+    glUniform1i(isLightSourceLoc, mat.isLightSource);
 
-        if (type == "v") {
-            glm::vec3 vertex;
-            iss >> vertex.x >> vertex.y >> vertex.z;
-            temp_vertices.push_back(vertex);
-        }
-        else if (type == "vt") {
-            glm::vec2 tex;
-            iss >> tex.x >> tex.y;
-            temp_texcoords.push_back(tex);
-        }
-        else if (type == "vn") {
-            glm::vec3 normal;
-            iss >> normal.x >> normal.y >> normal.z;
-            temp_normals.push_back(normal);
-        }
-        else if (type == "usemtl") {
-            if (!current_material.empty()) {
-                materialGroups.back().second.second = vertex_count - materialGroups.back().second.first;
-            }
-            
-            iss >> current_material;
-            std::cout << current_material << " vertice inicial = " << vertex_count << std::endl;
-            materialGroups.push_back({current_material, {vertex_count, 0}});
-        }
-        else if (type == "f") {
-            std::string v1, v2, v3;
-            iss >> v1 >> v2 >> v3;
-
-            auto process_vertex = [&](const std::string& v) {
-                std::stringstream ss(v);
-                std::string index_str;
-                std::vector<int> indices;
-                
-                while (std::getline(ss, index_str, '/')) {
-                    indices.push_back(!index_str.empty() ? std::stoi(index_str) : 0);
-                }
-
-                Vertex vertex;
-                vertex.position = temp_vertices[indices[0] - 1];
-                vertex.texture_coord = indices[1] > 0 ? temp_texcoords[indices[1] - 1] : glm::vec2(0.0f);
-                vertex.normal = indices[2] > 0 ? temp_normals[indices[2] - 1] : glm::vec3(0.0f, 1.0f, 0.0f);
-                vertices.push_back(vertex);
-                vertex_count++;
-            };
-
-            process_vertex(v1);
-            process_vertex(v2);
-            process_vertex(v3);
-        }
-    }
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
 
-    if (!current_material.empty()) {
-        materialGroups.back().second.second = vertex_count - materialGroups.back().second.first;
-    }
+    GLint loc_texture = glGetUniformLocation(shaderProgram, "material.diffuse");
+    glUniform1i(loc_texture, 0);
 
-    return true;
+    glUniform3fv(diffuseReflectionLoc, 1, glm::value_ptr(mat.diffuseReflection));
+    glUniform3fv(specularReflectionLoc, 1, glm::value_ptr(mat.specularReflection));
 }
 
-bool Object::LoadTexture(const char* path, GLuint& texture) {
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
+void Object::DrawDepth(GLuint depthProgram, const glm::mat4& modelMatrix, size_t lod) const {
+    glUniformMatrix4fv(glGetUniformLocation(depthProgram, "model"), 1, GL_FALSE, glm::value_ptr(modelMatrix));
+    mesh->BindDecode(depthProgram);
+    glBindVertexArray(mesh->GetDepthVAO());
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    int width, height, channels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load(path, &width, &height, &channels, 0);
-    
-    if (data) {
-        std::cout << path << " ";
-        if (channels == 4) {
-            std::cout << "RGBA" << std::endl;
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        } else {
-            std::cout << "RGB" << std::endl;
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        }
-        stbi_image_free(data);
-        return true;
+    // mesmos intervalos do Draw, para o teste GL_EQUAL bater vértice a vértice
+    for (const auto& range : mesh->lods[lod]) {
+        size_t end = std::min(range.first + range.second, mesh->ResidentVertices());
+        if (end > range.first)
+            glDrawArrays(GL_TRIANGLES, range.first, end - range.first);
     }
-    
-    std::cerr << "Failed to load texture: " << path << std::endl;
-    return false;
 }
 
-void Object::Draw(bool mesh_active) {
-    glUseProgram(shaderProgram);
+size_t Object::SelectLod(float screenSize) {
+    size_t count = mesh->LodCount();
+    size_t level = std::min(lodLevel, count - 1);
+    while (level > 0 && screenSize > kLodScreenSize[level] * (1.0f + kLodHysteresis))
+        level--;
+    while (level + 1 < count && screenSize < kLodScreenSize[level + 1] * (1.0f - kLodHysteresis))
+        level++;
+    lodLevel = level;
+    return level;
+}
 
-    model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(xPos, yPos, zPos));
-    
-    glm::vec3 rotation_axis(0.0f, 1.0f, 0.0f);
-    if (axis == 0) rotation_axis = glm::vec3(1.0f, 0.0f, 0.0f);
-    if (axis == 2) rotation_axis = glm::vec3(0.0f, 0.0f, 1.0f);
-    
-    model = glm::rotate(model, angle, rotation_axis);
-    model = glm::scale(model, glm::vec3(scale));
+bool Object::UseImpostor(float distance) {
+    if (impostorDistance <= 0.0f)
+        return false;
+    float limit = impostorDistance * (impostorActive ? 1.0f - kLodHysteresis : 1.0f + kLodHysteresis);
+    impostorActive = distance > limit;
+    return impostorActive;
+}
 
-    GLint loc_model = glGetUniformLocation(shaderProgram, "model");
-    glUniformMatrix4fv(loc_model, 1, GL_FALSE, glm::value_ptr(model));
-
-    glBindVertexArray(vao);
-
-    for (size_t i = 0; i < materialGroups.size(); i++) {
-        GLint emissionLoc = glGetUniformLocation(shaderProgram, "material.emission");
-        GLint shininessLoc = glGetUniformLocation(shaderProgram, "material.shininess");
-        GLint isLightSourceLoc = glGetUniformLocation(shaderProgram, "material.isLightSource");
-        GLint constantLoc = glGetUniformLocation(shaderProgram, "material.constant");
-        GLint linearLoc = glGetUniformLocation(shaderProgram, "material.linear");
-        GLint quadraticLoc = glGetUniformLocation(shaderProgram, "material.quadratic");
-        GLint cutOffLoc = glGetUniformLocation(shaderProgram, "material.cutOff");
-        GLint outerCutOffLoc = glGetUniformLocation(shaderProgram, "material.outerCutOff");
-        GLint directionLoc = glGetUniformLocation(shaderProgram, "material.direction");
-        GLint isActiveLoc = glGetUniformLocation(shaderProgram, "material.isActive");
-        GLint diffuseReflectionLoc = glGetUniformLocation(shaderProgram, "material.diffuseReflection");
-        GLint specularReflectionLoc = glGetUniformLocation(shaderProgram, "material.specularReflection");
-
-        // esses são ignorados no shader caso não seja fonte de luz
-        const auto& mat = materials[i];
-        glUniform3fv(emissionLoc, 1, glm::value_ptr(mat.emission));
-        glUniform1f(shininessLoc, mat.shininess);
-        glUniform1i(isLightSourceLoc, mat.isLightSource);
-        glUniform1f(constantLoc, mat.constant);
-        glUniform1f(linearLoc, mat.linear);
-        glUniform1f(quadraticLoc, mat.quadratic);
-        glUniform1f(cutOffLoc, mat.cutOff);
-        glUniform1f(outerCutOffLoc, mat.outerCutOff);
-        glUniform3fv(directionLoc, 1, glm::value_ptr(mat.direction));
-        glUniform1i(isActiveLoc, mat.isActive);
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, textures[i]);
-
-        GLint loc_texture = glGetUniformLocation(shaderProgram, "material.diffuse");
-        glUniform1i(loc_texture, 0);
-
-        glUniform3fv(diffuseReflectionLoc, 1, glm::value_ptr(mat.diffuseReflection));
-        glUniform3fv(specularReflectionLoc, 1, glm::value_ptr(mat.specularReflection));
-
-        const auto& group = materialGroups[i];
-        glDrawArrays(GL_TRIANGLES, group.second.first, group.second.second);
+void Object::GetWorldBounds(const glm::mat4& modelMatrix, glm::vec3& outMin, glm::vec3& outMax) const {
+    const glm::vec3& lo = mesh->boundsMin;
+    const glm::vec3& hi = mesh->boundsMax;
+    for (int i = 0; i < 8; i++) {
+        glm::vec3 corner((i & 1) ? hi.x : lo.x, (i & 2) ? hi.y : lo.y, (i & 4) ? hi.z : lo.z);
+        glm::vec3 world = glm::vec3(modelMatrix * glm::vec4(corner, 1.0f));
+        outMin = i == 0 ? world : glm::min(outMin, world);
+        outMax = i == 0 ? world : glm::max(outMax, world);
     }
 }
 
@@ -224,14 +145,17 @@ void Object::Move(float dx, float dy, float dz) {
     xPos += dx;
     yPos += dy;
     zPos += dz;
+    revision++;
 }
 
 void Object::Scale(float factor) {
     scale -= factor;
+    revision++;
 }
 
 void Object::Rotate(float angle_delta) {
     angle += angle_delta;
+    revision++;
 }
 
 void Object::ToggleLights() {
@@ -240,14 +164,18 @@ void Object::ToggleLights() {
             mat.isActive = !mat.isActive;
         }
     }
+    revision++;
 }
 
 glm::mat4 Object::GetModelMatrix() {
-    return model;
-}
+    model = glm::mat4(1.0f);
+    model = glm::translate(model, glm::vec3(xPos, yPos, zPos));
 
-Object::~Object() {
-    if (vao) glDeleteVertexArrays(1, &vao);
-    if (vbo) glDeleteBuffers(1, &vbo);
-    if (!textures.empty()) glDeleteTextures(textures.size(), textures.data());
+    glm::vec3 rotation_axis(0.0f, 1.0f, 0.0f);
+    if (axis == 0) rotation_axis = glm::vec3(1.0f, 0.0f, 0.0f);
+    if (axis == 2) rotation_axis = glm::vec3(0.0f, 0.0f, 1.0f);
+
+    model = glm::rotate(model, angle, rotation_axis);
+    model = glm::scale(model, glm::vec3(scale));
+    return model;
 }
@@ -8,13 +8,8 @@
 #include <vector>
 #include <string>
 #include <map>
-
-
-struct Vertex {
-    glm::vec3 position;
-    glm::vec2 texture_coord;
-    glm::vec3 normal;
-};
+#include <memory>
+#include "Mesh.h"
 
 struct MaterialProperties {
     glm::vec3 emission{0.0f};
@@ -57,36 +52,77 @@ struct MaterialProperties {
     {}
 };
 
+// Uniforms "material.*" e a textura na unidade 0, como fs.glsl e gbuffer_fs.glsl esperam
+void ApplyMaterial(GLuint shaderProgram, const MaterialProperties& material, GLuint texture);
+
 class Object {
 public:
     std::string name;
     std::vector<MaterialProperties> materials;
     glm::mat4 model;
 
-    Object(GLuint shaderProgram, const char* objPath, 
-           const std::vector<const char*>& texturePaths,
+    // mesh e texturas são compartilhados (pertencem ao cache), um por grupo de material.
+    // Mesh em streaming: os grupos só são conferidos quando o layout sai (Drawable)
+    Object(std::shared_ptr<Mesh> mesh,
+           const std::vector<GLuint>& textures,
            const std::vector<MaterialProperties>& matProperties,
            float _xPos = 0.0f, float _yPos = 0.0f, float _zPos = 0.0f, 
            float _scale = 1.0f, float _angle = 0.0f, int axis = 1);
-    ~Object();
     
     float xPos, yPos, zPos, scale, angle;
-    void Draw(bool mesh_active);
+    float spinSpeed{0.0f};  // rotação contínua em rad/s (céu)
+
+    // Feixe de spotlight em coordenadas do modelo (olhos do gigante, lanterna)
+    bool hasLightBeam{false};
+    glm::vec3 lightBeamOrigin{0.0f};
+    glm::vec3 lightBeamTarget{0.0f, 0.0f, -1.0f};
+
+    // A partir desta distância da câmera o objeto vira impostor (Impostors); 0 = nunca
+    float impostorDistance{0.0f};
+    // Desenhado (com Mesh::occluder) no rasterizador de oclusão da CPU
+    bool occluder{false};
+
+    // Desenha com o estado congelado do frame (pode rodar na thread de render). O programa precisa
+    // ter os uniforms "model" e "material.*" (forward em fs.glsl ou G-buffer em gbuffer_fs.glsl)
+    void Draw(GLuint shaderProgram, const glm::mat4& modelMatrix, const std::vector<MaterialProperties>& frameMaterials,
+              size_t lod = 0);
+    // Um grupo de material por vez, para trocar de programa entre grupos (variantes de fs.glsl)
+    size_t GroupCount() const { return mesh->materialGroups.size(); }
+    void SetModel(GLuint shaderProgram, const glm::mat4& modelMatrix) const;
+    void DrawGroup(GLuint shaderProgram, size_t group, const MaterialProperties& material, size_t lod = 0) const;
+    // Só profundidade, com o programa do pre-pass já em uso (mesmo lod do shading, por causa do GL_EQUAL)
+    void DrawDepth(GLuint depthProgram, const glm::mat4& modelMatrix, size_t lod = 0) const;
+    // Nível de detalhe pelo tamanho projetado (raio da esfera envolvente / meia altura da tela),
+    // com histerese em volta de cada limiar; guarda o nível escolhido para o próximo frame
+    size_t SelectLod(float screenSize);
+    size_t TriangleCount(size_t lod) const { return mesh->TriangleCount(lod); }
+    // Troca para o impostor além de impostorDistance, com a mesma folga dos níveis de detalhe
+    bool UseImpostor(float distance);
+    const Mesh& GetMesh() const { return *mesh; }
+    // Simulação: false enquanto o mesh em streaming não tem layout (e para sempre se os materiais
+    // não cobrem os grupos do .obj); só objetos desenháveis entram no snapshot
+    bool Drawable();
+    const std::vector<GLuint>& GetTextures() const { return textures; }
+    // AABB do mesh transformada para o mundo
+    void GetWorldBounds(const glm::mat4& modelMatrix, glm::vec3& outMin, glm::vec3& outMax) const;
     void Move(float dx, float dy, float dz);
     void Scale(float factor);
     void Rotate(float angle);
     glm::mat4 GetModelMatrix();
     void ToggleLights();
+    // Muda a cada Move/Scale/Rotate/ToggleLights; shadow maps em cache comparam com ela
+    unsigned Revision() const { return revision; }
 private:
-    GLuint vao{0}, vbo{0};
-    GLuint shaderProgram;
-    std::vector<Vertex> vertices;
+    std::shared_ptr<Mesh> mesh;
     std::vector<GLuint> textures;
-    std::vector<std::pair<std::string, std::pair<size_t, size_t>>> materialGroups; 
     int axis;
+    unsigned revision{0};
+    size_t lodLevel{0};
+    bool impostorActive{false};
+    bool drawable{false};
+    bool mismatched{false};
 
-    bool LoadOBJ(const char* path);
-    bool LoadTexture(const char* path, GLuint& texture);
+    bool MaterialsCoverGroups() const;
 };
 
 #endif
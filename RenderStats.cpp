@@ -0,0 +1,92 @@
+// RenderStats.cpp
+#include "RenderStats.h"
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+
+RenderStats::~RenderStats() {
+    Destroy();
+}
+
+RenderStats::Counter& RenderStats::Find(const char* name) {
+    for (auto& counter : counters) {
+        if (strcmp(counter.name, name) == 0)
+            return counter;
+    }
+    counters.push_back({name, 0.0, 0});
+    return counters.back();
+}
+
+void RenderStats::Count(const char* name, double value) {
+    if (!enabled)
+        return;
+
+    Find(name).total += value;
+}
+
+void RenderStats::Sample(const char* name, double value) {
+    if (!enabled)
+        return;
+
+    Counter& counter = Find(name);
+    counter.total += value;
+    counter.samples++;
+}
+
+void RenderStats::BeginSamples() {
+    if (!enabled)
+        return;
+
+    if (!queries[0])
+        glGenQueries(2, queries);
+    glBeginQuery(GL_SAMPLES_PASSED, queries[frameIndex & 1]);
+}
+
+void RenderStats::EndSamples() {
+    if (!enabled)
+        return;
+
+    glEndQuery(GL_SAMPLES_PASSED);
+    queryIssued[frameIndex & 1] = true;
+}
+
+void RenderStats::EndFrame(double frameSeconds, int pixels) {
+    if (!enabled)
+        return;
+
+    // resultado do frame anterior
+    int previous = (frameIndex + 1) & 1;
+    if (queryIssued[previous]) {
+        GLuint available = 0;
+        glGetQueryObjectuiv(queries[previous], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint samples = 0;
+            glGetQueryObjectuiv(queries[previous], GL_QUERY_RESULT, &samples);
+            // nem todo frame tem o resultado pronto
+            Sample("frags/px", static_cast<double>(samples) / pixels);
+            queryIssued[previous] = false;
+        }
+    }
+    frameIndex++;
+
+    frames++;
+    elapsed += frameSeconds;
+    Count("ms", frameSeconds * 1000.0);
+    if (elapsed < 1.0)
+        return;
+
+    std::cout << "[stats]" << std::fixed << std::setprecision(2);
+    for (const auto& counter : counters) {
+        std::cout << " " << counter.name << " " << counter.total / (counter.samples ? counter.samples : frames);
+    }
+    std::cout << std::defaultfloat << std::endl;
+
+    counters.clear();
+    frames = 0;
+    elapsed = 0.0;
+}
+
+void RenderStats::Destroy() {
+    if (queries[0]) glDeleteQueries(2, queries);
+    queries[0] = queries[1] = 0;
+}
@@ -0,0 +1,50 @@
+// RenderStats.h
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+#include <GL/glew.h>
+#include <vector>
+
+// Contadores da thread de render, somados por frame e impressos como média a cada segundo (--stats).
+//   stats.Count("tris", n);           valor deste frame
+//   stats.Sample("frags/px", v);      valor que nem todo frame tem: média só entre as amostras
+//   stats.BeginSamples()/EndSamples() amostras de fragmento que passaram no teste de profundidade
+class RenderStats {
+public:
+    RenderStats() = default;
+    ~RenderStats();
+    RenderStats(const RenderStats&) = delete;
+    RenderStats& operator=(const RenderStats&) = delete;
+
+    void SetEnabled(bool on) { enabled = on; }
+    bool Enabled() const { return enabled; }
+
+    void Count(const char* name, double value);
+    void Sample(const char* name, double value);
+
+    // GL_SAMPLES_PASSED em ping-pong: o resultado lido é o do frame anterior, sem travar a GPU
+    void BeginSamples();
+    void EndSamples();
+
+    void EndFrame(double frameSeconds, int pixels);
+    void Destroy();
+
+private:
+    bool enabled{false};
+    GLuint queries[2]{0, 0};
+    bool queryIssued[2]{false, false};
+    int frameIndex{0};
+
+    int frames{0};
+    double elapsed{0.0};
+    struct Counter {
+        const char* name;
+        double total;
+        int samples;  // chamadas de Sample; 0: contador de Count, média por frame
+    };
+    std::vector<Counter> counters;
+
+    Counter& Find(const char* name);
+};
+
+#endif
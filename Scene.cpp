@@ -0,0 +1,265 @@
+// Scene.cpp
+#include "Scene.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <cstdlib>
+#include <sys/stat.h>
+#include "Tracer.h"
+
+namespace {
+
+// Percorre os tokens de uma linha, com mensagens de erro apontando arquivo:linha
+struct LineReader {
+    std::vector<std::string> tokens;
+    size_t pos{0};
+    std::string where;
+
+    bool Done() const { return pos >= tokens.size(); }
+    const std::string& Peek() const { return tokens[pos]; }
+
+    [[noreturn]] void Fail(const std::string& message) const {
+        throw std::runtime_error(where + ": " + message);
+    }
+
+    std::string Word() {
+        if (Done()) Fail("unexpected end of line");
+        return tokens[pos++];
+    }
+
+    bool NextIsNumber() const {
+        if (Done()) return false;
+        char* end = nullptr;
+        strtof(tokens[pos].c_str(), &end);
+        return end != tokens[pos].c_str() && *end == '\0';
+    }
+
+    float Number() {
+        if (!NextIsNumber()) Fail("expected a number" + (Done() ? std::string() : ", got '" + Peek() + "'"));
+        return strtof(tokens[pos++].c_str(), nullptr);
+    }
+
+    glm::vec3 Vec3() {
+        float x = Number();
+        float y = Number();
+        return glm::vec3(x, y, Number());
+    }
+
+    // aceita um valor (cinza) ou três (rgb)
+    glm::vec3 Color() {
+        float r = Number();
+        if (!NextIsNumber()) return glm::vec3(r);
+        float g = Number();
+        return glm::vec3(r, g, Number());
+    }
+};
+
+bool FileExists(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+}
+
+void ParseSun(LineReader& in, SceneDescription& scene) {
+    while (!in.Done()) {
+        std::string key = in.Word();
+        if (key == "position") scene.sunPosition = in.Vec3();
+        else if (key == "ambient") scene.sunAmbient = in.Color();
+        else if (key == "diffuse") scene.sunDiffuse = in.Color();
+        else if (key == "specular") scene.sunSpecular = in.Color();
+        else in.Fail("unknown sun attribute '" + key + "'");
+    }
+}
+
+void ParseSky(LineReader& in, SceneDescription& scene) {
+    while (!in.Done()) {
+        std::string key = in.Word();
+        if (key == "texture") scene.skyTexture = in.Word();
+        else if (key == "spin") scene.skySpin = in.Number();
+        else if (key == "brightness") scene.skyBrightness = in.Number();
+        else in.Fail("unknown sky attribute '" + key + "'");
+    }
+}
+
+void ParseGrass(LineReader& in, SceneDescription& scene) {
+    SceneGrass& grass = scene.grass;
+    while (!in.Done()) {
+        std::string key = in.Word();
+        if (key == "material") {
+            grass.material = in.Word();
+            if (!scene.materials.count(grass.material)) in.Fail("unknown material '" + grass.material + "'");
+        }
+        else if (key == "radius") grass.radius = in.Number();
+        else if (key == "height") grass.height = in.Number();
+        else if (key == "spacing") grass.spacing = in.Number();
+        else if (key == "blade") grass.bladeHeight = in.Number();
+        else in.Fail("unknown grass attribute '" + key + "'");
+    }
+    if (grass.material.empty()) in.Fail("grass has no material");
+    if (grass.spacing < 0.1f) in.Fail("grass spacing must be at least 0.1");
+}
+
+void ParseMaterial(LineReader& in, SceneDescription& scene) {
+    std::string name = in.Word();
+    if (scene.materials.count(name)) in.Fail("material '" + name + "' already defined");
+
+    SceneMaterial material;
+    MaterialProperties& props = material.properties;
+    while (!in.Done()) {
+        std::string key = in.Word();
+        if (key == "texture") material.texture = in.Word();
+        else if (key == "emission") props.emission = in.Color();
+        else if (key == "diffuse") props.diffuseReflection = in.Color();
+        else if (key == "specular") props.specularReflection = in.Color();
+        else if (key == "shininess") props.shininess = in.Number();
+        else if (key == "light") props.isLightSource = true;
+        else if (key == "attenuation") {
+            props.constant = in.Number();
+            props.linear = in.Number();
+            props.quadratic = in.Number();
+        }
+        else if (key == "spot") {
+            props.cutOff = glm::cos(glm::radians(in.Number()));
+            props.outerCutOff = glm::cos(glm::radians(in.Number()));
+        }
+        else if (key == "direction") props.direction = in.Vec3();
+        else in.Fail("unknown material attribute '" + key + "'");
+    }
+    if (material.texture.empty()) in.Fail("material '" + name + "' has no texture");
+
+    scene.materials[name] = material;
+}
+
+void ParseInstance(LineReader& in, SceneDescription& scene, int line) {
+    SceneInstance instance;
+    instance.line = line;
+    instance.mesh = in.Word();
+    if (!scene.meshes.count(instance.mesh)) in.Fail("unknown mesh '" + instance.mesh + "'");
+
+    static const std::set<std::string> keywords = {
+        "position", "scale", "angle", "axis", "spin", "beam", "impostor", "occluder", "materials"
+    };
+    while (!in.Done()) {
+        std::string key = in.Word();
+        if (key == "position") instance.position = in.Vec3();
+        else if (key == "scale") instance.scale = in.Number();
+        else if (key == "angle") instance.angle = in.Number();
+        else if (key == "axis") instance.axis = static_cast<int>(in.Number());
+        else if (key == "spin") instance.spin = in.Number();
+        else if (key == "beam") {
+            instance.hasBeam = true;
+            instance.beamOrigin = in.Vec3();
+            instance.beamTarget = in.Vec3();
+        }
+        else if (key == "impostor") instance.impostorDistance = in.Number();
+        else if (key == "occluder") instance.occluder = true;
+        else if (key == "materials") {
+            while (!in.Done() && !keywords.count(in.Peek())) {
+                std::string material = in.Word();
+                if (!scene.materials.count(material)) in.Fail("unknown material '" + material + "'");
+                instance.materials.push_back(material);
+            }
+        }
+        else in.Fail("unknown instance attribute '" + key + "'");
+    }
+    if (instance.impostorDistance > 0.0f && instance.axis != 1) in.Fail("impostor needs axis 1");
+
+    scene.instances.push_back(instance);
+}
+
+} // namespace
+
+SceneDescription LoadSceneFile(const char* path) {
+    TRACE_SCOPE_DETAIL("LoadSceneFile", path);
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error(std::string("Cannot open scene file: ") + path);
+    }
+
+    SceneDescription scene;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        LineReader in;
+        in.where = std::string(path) + ":" + std::to_string(lineNumber);
+        std::istringstream iss(line);
+        std::string token;
+        while (iss >> token) in.tokens.push_back(token);
+        if (in.Done()) continue;
+
+        std::string type = in.Word();
+        if (type == "sun") {
+            ParseSun(in, scene);
+        }
+        else if (type == "sky") {
+            ParseSky(in, scene);
+        }
+        else if (type == "grass") {
+            ParseGrass(in, scene);
+        }
+        else if (type == "mesh") {
+            std::string name = in.Word();
+            if (scene.meshes.count(name)) in.Fail("mesh '" + name + "' already defined");
+            scene.meshes[name] = in.Word();
+        }
+        else if (type == "material") {
+            ParseMaterial(in, scene);
+        }
+        else if (type == "instance") {
+            ParseInstance(in, scene, lineNumber);
+        }
+        else {
+            in.Fail("unknown declaration '" + type + "'");
+        }
+
+        if (!in.Done()) in.Fail("unexpected '" + in.Peek() + "'");
+    }
+
+    return scene;
+}
+
+std::vector<std::string> ValidateSceneAssets(SceneDescription& scene) {
+    TRACE_SCOPE("ValidateSceneAssets");
+    std::vector<std::string> missing;
+
+    std::set<std::string> missingMeshes;
+    for (const auto& mesh : scene.meshes) {
+        if (!FileExists(mesh.second)) {
+            missing.push_back(mesh.second);
+            missingMeshes.insert(mesh.first);
+        }
+    }
+    std::set<std::string> missingTextures;
+    for (auto& material : scene.materials) {
+        if (!FileExists(material.second.texture)) {
+            if (missingTextures.insert(material.second.texture).second)
+                missing.push_back(material.second.texture);
+            material.second.texture.clear();
+        }
+    }
+
+    if (!scene.skyTexture.empty() && !FileExists(scene.skyTexture)) {
+        missing.push_back(scene.skyTexture);
+        scene.skyTexture.clear();
+    }
+
+    for (auto it = scene.instances.begin(); it != scene.instances.end();) {
+        if (missingMeshes.count(it->mesh)) {
+            std::cerr << "Skipping instance of '" << it->mesh << "' (line " << it->line
+                      << "): mesh file is missing" << std::endl;
+            it = scene.instances.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (const auto& path : missing) {
+        std::cerr << "Missing asset: " << path << std::endl;
+    }
+    return missing;
+}
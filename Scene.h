@@ -0,0 +1,79 @@
+// Scene.h
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <glm/glm.hpp>
+#include <map>
+#include <string>
+#include <vector>
+#include "Object.h"
+
+// Descrição de cena lida de um arquivo texto (ver scenes/default.scene para o formato).
+// Uma linha por declaração:
+//   sun      position x y z [ambient v] [diffuse v] [specular v]
+//   sky      texture <equiretangular> [spin rad/s] [brightness v]
+//   grass    material <nome> radius r [height y] [spacing s] [blade h]   (material declarado antes)
+//   mesh     <nome> <arquivo .obj>
+//   material <nome> texture <arquivo> [emission v|r g b] [diffuse v|r g b] [specular v|r g b]
+//            [shininess s] [light] [attenuation c l q] [spot interno externo] [direction x y z]
+//   instance <mesh> [position x y z] [scale s] [angle a] [axis 0|1|2] [spin rad/s]
+//            [beam ox oy oz tx ty tz] [impostor distância] [occluder] materials <m1> <m2> ...
+//            (impostor só para axis 1: o quad gira em volta de Y; occluder esconde outros objetos
+//            no rasterizador de oclusão da CPU; sem materials, usa os do .mtl do .obj por grupo)
+
+struct SceneMaterial {
+    std::string texture;
+    MaterialProperties properties;
+};
+
+// Grama instanciada sobre o chão (GrassField): disco de raio radius na altura height,
+// tufos a pelo menos spacing um do outro, lâminas de até blade de altura
+struct SceneGrass {
+    std::string material;
+    float radius{0.0f};  // 0: sem grama
+    float height{0.0f};
+    float spacing{0.5f};
+    float bladeHeight{0.6f};
+};
+
+struct SceneInstance {
+    std::string mesh;
+    std::vector<std::string> materials;  // vazio: os do .mtl (Mesh::objMaterials)
+    glm::vec3 position{0.0f};
+    float scale{1.0f};
+    float angle{0.0f};
+    int axis{1};
+    float spin{0.0f};
+    bool hasBeam{false};
+    glm::vec3 beamOrigin{0.0f};
+    glm::vec3 beamTarget{0.0f, 0.0f, -1.0f};
+    float impostorDistance{0.0f};
+    bool occluder{false};
+    int line{0};
+};
+
+struct SceneDescription {
+    glm::vec3 sunPosition{0.0f, 150.0f, 0.0f};
+    glm::vec3 sunAmbient{0.2f};
+    glm::vec3 sunDiffuse{0.02f};
+    glm::vec3 sunSpecular{0.2f};
+
+    std::string skyTexture;        // vazio: sem céu
+    float skySpin{0.0f};
+    float skyBrightness{1.0f};
+
+    SceneGrass grass;
+
+    std::map<std::string, std::string> meshes;        // nome -> arquivo
+    std::map<std::string, SceneMaterial> materials;   // nome -> material
+    std::vector<SceneInstance> instances;             // na ordem do arquivo (teclas 1-9)
+};
+
+// Erros de sintaxe/referência lançam std::runtime_error com arquivo:linha
+SceneDescription LoadSceneFile(const char* path);
+
+// Confere todos os arquivos referenciados de uma vez. Instâncias com mesh ausente são removidas
+// e texturas ausentes ficam vazias (o renderer usa a textura substituta). Retorna os arquivos que faltam.
+std::vector<std::string> ValidateSceneAssets(SceneDescription& scene);
+
+#endif
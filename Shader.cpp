@@ -0,0 +1,285 @@
+// Shader.cpp
+#include "Shader.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <vector>
+#include <sys/stat.h>
+
+namespace {
+
+struct ProgramCache {
+    bool enabled{false};
+    std::string directory;
+    std::string driver;  // vendor/renderer/versão: binários só valem para o mesmo driver
+    ProgramCacheStats stats;
+    std::map<GLuint, std::string> paths;  // programa -> binário de onde veio (ou para onde foi)
+    std::set<std::string> released;       // de programas cujo nome GL o driver já reaproveitou
+};
+ProgramCache programCache;
+
+const char kCacheMagic[4] = {'P', 'B', 'C', '1'};
+
+uint64_t HashSources(const std::string& vertexSource, const std::string& fragmentSource, const std::string& driver) {
+    const std::string separator(1, '\xff');  // entre as partes
+    uint64_t hash = kTextHashSeed;
+    for (const std::string* part : {&vertexSource, &fragmentSource, &driver}) {
+        hash = HashText(separator, HashText(*part, hash));
+    }
+    return hash;
+}
+
+std::string CachePath(uint64_t hash) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(hash));
+    return programCache.directory + "/" + name;
+}
+
+// Arquivo: magic, hash, driver, formato, tamanho, binário
+GLuint LoadCachedProgram(const std::string& path, uint64_t hash) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return 0;
+
+    char magic[4];
+    uint64_t fileHash = 0;
+    uint32_t driverLength = 0, length = 0;
+    GLenum format = 0;
+    file.read(magic, 4);
+    file.read(reinterpret_cast<char*>(&fileHash), sizeof(fileHash));
+    file.read(reinterpret_cast<char*>(&driverLength), sizeof(driverLength));
+    if (!file || std::string(magic, 4) != std::string(kCacheMagic, 4) || fileHash != hash ||
+            driverLength != programCache.driver.size())
+        return 0;
+
+    std::string driver(driverLength, '\0');
+    file.read(&driver[0], driver.size());
+    file.read(reinterpret_cast<char*>(&format), sizeof(format));
+    file.read(reinterpret_cast<char*>(&length), sizeof(length));
+    if (!file || driver != programCache.driver || length > (64u << 20))
+        return 0;
+
+    std::vector<char> binary(length);
+    file.read(binary.data(), length);
+    if (!file)
+        return 0;
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, format, binary.data(), static_cast<GLsizei>(length));
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        // driver atualizado ou binário corrompido: recompila e sobrescreve
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void SaveCachedProgram(const std::string& path, uint64_t hash, GLuint program) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    // grava num temporário e renomeia: um arquivo pela metade nunca é lido
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        uint32_t driverLength = static_cast<uint32_t>(programCache.driver.size());
+        uint32_t size = static_cast<uint32_t>(length);
+        file.write(kCacheMagic, 4);
+        file.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+        file.write(reinterpret_cast<const char*>(&driverLength), sizeof(driverLength));
+        file.write(programCache.driver.data(), driverLength);
+        file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        file.write(binary.data(), length);
+        if (!file) {
+            std::cerr << "Cannot write program cache " << temporary << std::endl;
+            return;
+        }
+    }
+    std::rename(temporary.c_str(), path.c_str());
+}
+
+GLuint CompileAndLink(const std::string& vertexSource, const std::string& fragmentSource, bool retrievable) {
+    GLuint vs = CreateShader(GL_VERTEX_SHADER, vertexSource.c_str());
+    GLuint fs = 0;
+    try {
+        fs = CreateShader(GL_FRAGMENT_SHADER, fragmentSource.c_str());
+    } catch (...) {
+        glDeleteShader(vs);  // hot reload: cada gravação com erro vazaria um shader
+        throw;
+    }
+
+    GLuint program = glCreateProgram();
+    if (retrievable)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glLinkProgram(program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        glDeleteProgram(program);
+        throw std::runtime_error("Shader program linking failed: " + std::string(infoLog));
+    }
+
+    return program;
+}
+
+} // namespace
+
+std::string loadShaderFromFile(const char* filePath) {
+    std::string shaderCode;
+    std::ifstream shaderFile;
+
+    shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
+    try {
+
+        shaderFile.open(filePath);
+        std::stringstream shaderStream;
+
+        shaderStream << shaderFile.rdbuf();
+
+        shaderFile.close();
+
+        shaderCode = shaderStream.str();
+    }
+    catch (std::ifstream::failure& e) {
+        std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
+    }
+
+    return shaderCode;
+}
+
+std::string InsertAfterVersion(const std::string& source, const std::string& text) {
+    size_t version = source.find("#version");
+    size_t lineEnd = version == std::string::npos ? std::string::npos : source.find('\n', version);
+    if (lineEnd == std::string::npos)
+        return text + "\n" + source;
+    return source.substr(0, lineEnd + 1) + text + "\n" + source.substr(lineEnd + 1);
+}
+
+uint64_t HashText(const std::string& text, uint64_t hash) {
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 1099511628211ull;  // FNV-1a
+    }
+    return hash;
+}
+
+GLuint CreateShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        glDeleteShader(shader);
+        throw std::runtime_error("Shader compilation failed: " + std::string(infoLog));
+    }
+
+    return shader;
+}
+
+GLuint CreateProgram(const std::string& vertexSource, const std::string& fragmentSource) {
+    auto start = std::chrono::steady_clock::now();
+    GLuint program = 0;
+
+    if (programCache.enabled) {
+        uint64_t hash = HashSources(vertexSource, fragmentSource, programCache.driver);
+        std::string path = CachePath(hash);
+        program = LoadCachedProgram(path, hash);
+        if (program) {
+            programCache.stats.loaded++;
+        } else {
+            program = CompileAndLink(vertexSource, fragmentSource, true);
+            SaveCachedProgram(path, hash, program);
+            programCache.stats.compiled++;
+        }
+        // nome reaproveitado: o programa anterior com esse nome já foi apagado
+        auto previous = programCache.paths.find(program);
+        if (previous != programCache.paths.end() && previous->second != path)
+            programCache.released.insert(previous->second);
+        programCache.paths[program] = path;
+    } else {
+        program = CompileAndLink(vertexSource, fragmentSource, false);
+        programCache.stats.compiled++;
+    }
+
+    programCache.stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return program;
+}
+
+void EnableProgramCache(const std::string& directory) {
+    // core 4.1 ou ARB_get_program_binary, e pelo menos um formato de binário no driver
+    GLint formats = 0;
+    if (GLEW_ARB_get_program_binary)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) {
+        std::cerr << "Program binaries not supported by the driver; shaders compile from source" << std::endl;
+        return;
+    }
+
+    mkdir(directory.c_str(), 0755);
+    struct stat info;
+    if (stat(directory.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+        std::cerr << "Cannot create program cache directory " << directory << std::endl;
+        return;
+    }
+
+    const char* vendor = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    programCache.driver = std::string(vendor ? vendor : "") + "|" + (renderer ? renderer : "") + "|" +
+            (version ? version : "");
+    programCache.directory = directory;
+    programCache.enabled = true;
+}
+
+void PruneProgramCache() {
+    if (!programCache.enabled)
+        return;
+    // um programa em uso só é apagado de fato quando deixa de ser o atual
+    glUseProgram(0);
+    std::set<std::string> live;
+    for (auto it = programCache.paths.begin(); it != programCache.paths.end();) {
+        if (glIsProgram(it->first)) {
+            live.insert(it->second);
+            ++it;
+        } else {
+            programCache.released.insert(it->second);
+            it = programCache.paths.erase(it);
+        }
+    }
+    // um binário pode servir a mais de um programa (depth do pre-pass e das sombras)
+    for (const std::string& path : programCache.released) {
+        if (!live.count(path))
+            std::remove(path.c_str());
+    }
+    programCache.released.clear();
+}
+
+ProgramCacheStats GetProgramCacheStats() {
+    return programCache.stats;
+}
@@ -0,0 +1,37 @@
+// Shader.h
+#ifndef SHADER_H
+#define SHADER_H
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <string>
+
+std::string loadShaderFromFile(const char* filePath);
+
+// Insere um trecho logo depois da linha #version (GLSL não tem #include)
+std::string InsertAfterVersion(const std::string& source, const std::string& text);
+
+// FNV-1a de 64 bits; passar o hash anterior encadeia textos (chave do cache de programas, mudanças no hot reload)
+const uint64_t kTextHashSeed = 1469598103934665603ull;
+uint64_t HashText(const std::string& text, uint64_t hash = kTextHashSeed);
+
+// Lançam std::runtime_error com o log do driver em caso de falha
+GLuint CreateShader(GLenum type, const char* source);
+GLuint CreateProgram(const std::string& vertexSource, const std::string& fragmentSource);
+
+// Cache em disco de programas já linkados (glGetProgramBinary). Depois de habilitado,
+// CreateProgram procura um binário com o hash das fontes + vendor/renderer/versão do driver
+// e só compila quando não acha ou o driver recusa. Precisa do contexto GL.
+void EnableProgramCache(const std::string& directory);
+// Hot reload, depois de trocar os programas: apaga do cache os binários que só programas já
+// apagados (glDeleteProgram) usavam, para que cada recarga não deixe as versões antigas no disco
+void PruneProgramCache();
+
+struct ProgramCacheStats {
+    int loaded{0};          // vindos do cache
+    int compiled{0};        // compilados das fontes
+    double seconds{0.0};    // tempo total dentro de CreateProgram
+};
+ProgramCacheStats GetProgramCacheStats();
+
+#endif
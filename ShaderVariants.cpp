@@ -0,0 +1,94 @@
+// ShaderVariants.cpp
+#include "ShaderVariants.h"
+#include <algorithm>
+#include "Shader.h"
+#include "Tracer.h"
+
+namespace {
+
+const uint32_t kEmissive = 1u << 0;
+const uint32_t kNoSpecular = 1u << 1;
+const uint32_t kNoShadows = 1u << 2;
+const int kPointShift = 8;
+const int kSpotShift = 16;
+
+} // namespace
+
+void ShaderVariants::Initialize(const std::string& vertexSource, const std::string& fragmentSource) {
+    this->vertexSource = vertexSource;
+    this->fragmentSource = fragmentSource;
+}
+
+uint32_t ShaderVariants::KeyFor(const MaterialProperties& material, size_t pointLights, size_t spotLights, bool shadows) {
+    // fonte de luz não é iluminada: uma variante só para todas
+    if (material.isLightSource)
+        return kEmissive;
+
+    uint32_t key = 0;
+    if (material.specularReflection == glm::vec3(0.0f)) key |= kNoSpecular;
+    if (!shadows) key |= kNoShadows;
+    key |= static_cast<uint32_t>(std::min<size_t>(pointLights, kMaxLights)) << kPointShift;
+    key |= static_cast<uint32_t>(std::min<size_t>(spotLights, kMaxLights)) << kSpotShift;
+    return key;
+}
+
+std::string ShaderVariants::Defines(uint32_t key) {
+    if (key & kEmissive)
+        return "#define EMISSIVE\n#define NO_SHADOWS\n";
+
+    std::string defines;
+    if (key & kNoSpecular) defines += "#define NO_SPECULAR\n";
+    if (key & kNoShadows) defines += "#define NO_SHADOWS\n";
+    defines += "#define NUM_POINT_LIGHTS " + std::to_string((key >> kPointShift) & 0xff) + "\n";
+    defines += "#define NUM_SPOT_LIGHTS " + std::to_string((key >> kSpotShift) & 0xff) + "\n";
+    return defines;
+}
+
+GLuint ShaderVariants::Get(uint32_t key) {
+    auto it = programs.find(key);
+    if (it != programs.end())
+        return it->second;
+
+    GLuint program = Compile(key);
+    programs[key] = program;
+    return program;
+}
+
+GLuint ShaderVariants::Compile(uint32_t key) const {
+    TRACE_SCOPE("CompileShaderVariant");
+    return CreateProgram(vertexSource, InsertAfterVersion(fragmentSource, Defines(key)));
+}
+
+void ShaderVariants::Reload(const std::string& vertexSource, const std::string& fragmentSource) {
+    std::string oldVertex = this->vertexSource, oldFragment = this->fragmentSource;
+    this->vertexSource = vertexSource;
+    this->fragmentSource = fragmentSource;
+
+    std::map<uint32_t, GLuint> rebuilt;
+    try {
+        for (const auto& entry : programs) {
+            rebuilt[entry.first] = Compile(entry.first);
+        }
+    } catch (...) {
+        for (const auto& entry : rebuilt) {
+            glDeleteProgram(entry.second);
+        }
+        this->vertexSource = oldVertex;
+        this->fragmentSource = oldFragment;
+        throw;
+    }
+
+    Destroy();
+    programs.swap(rebuilt);
+}
+
+ShaderVariants::~ShaderVariants() {
+    Destroy();
+}
+
+void ShaderVariants::Destroy() {
+    for (const auto& entry : programs) {
+        glDeleteProgram(entry.second);
+    }
+    programs.clear();
+}
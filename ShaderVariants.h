@@ -0,0 +1,43 @@
+// ShaderVariants.h
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <map>
+#include <string>
+#include "Object.h"
+
+// Programas especializados de vs.glsl/fs.glsl, um por combinação de recursos, compilados
+// na primeira vez que um material precisa deles. Os #defines (ver o topo de fs.glsl) tiram
+// do shader os ramos que não se aplicam e fixam a quantidade de luzes dos laços.
+class ShaderVariants {
+public:
+    static const int kMaxLights = 10;  // por tipo, como o antigo MAX_LIGHTS de fs.glsl
+
+    ShaderVariants() = default;
+    ~ShaderVariants();
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    // fragmentSource já com shadow.glsl inserido
+    void Initialize(const std::string& vertexSource, const std::string& fragmentSource);
+    void Destroy();
+
+    // Chave compacta da variante: o que não influencia o resultado fica zerado
+    static uint32_t KeyFor(const MaterialProperties& material, size_t pointLights, size_t spotLights, bool shadows);
+    static std::string Defines(uint32_t key);
+
+    GLuint Get(uint32_t key);
+    // Recompila todas as variantes já usadas com as fontes novas; só troca se todas compilarem
+    void Reload(const std::string& vertexSource, const std::string& fragmentSource);
+    size_t Count() const { return programs.size(); }
+
+private:
+    std::string vertexSource, fragmentSource;
+    std::map<uint32_t, GLuint> programs;
+
+    GLuint Compile(uint32_t key) const;
+};
+
+#endif
@@ -0,0 +1,230 @@
+// ShadowMaps.cpp
+#include "ShadowMaps.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "Frustum.h"
+#include "Shader.h"
+#include "Tracer.h"
+
+namespace {
+
+const int kSunMapSize = 2048;
+const int kSpotMapSize = 1024;
+const float kSunDistance = 300.0f;  // posição da "câmera" do sol; cobre a cena de 200 unidades
+const float kSpotRange = 250.0f;    // mesmo limite dos volumes de luz do deferred
+// Largura de cada cascata; a última cobre a cena inteira de qualquer ponto
+const float kCascadeExtent[ShadowMaps::kCascades] = {24.0f, 80.0f, 440.0f};
+
+GLuint CreateDepthArray(int size, int layers) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, size, size, layers, 0,
+            GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // sampler2DArrayShadow: o hardware compara e filtra (PCF 2x2)
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return texture;
+}
+
+glm::vec3 UpFor(const glm::vec3& direction) {
+    return std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+}
+
+} // namespace
+
+void ShadowMaps::Initialize() {
+    program = CreateProgram(loadShaderFromFile("depth_vs.glsl"), loadShaderFromFile("depth_fs.glsl"));
+    sunTexture = CreateDepthArray(kSunMapSize, kCascades);
+    spotTexture = CreateDepthArray(kSpotMapSize, kMaxSpotShadows);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, sunTexture, 0, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        throw std::runtime_error("Shadow map framebuffer incomplete: " + std::to_string(status));
+    }
+}
+
+void ShadowMaps::ReloadProgram() {
+    GLuint reloaded = CreateProgram(loadShaderFromFile("depth_vs.glsl"), loadShaderFromFile("depth_fs.glsl"));
+    glDeleteProgram(program);
+    program = reloaded;
+}
+
+int ShadowMaps::Update(const FrameSnapshot& snapshot) {
+    if (!snapshot.shadows)
+        return 0;
+
+    TRACE_SCOPE("ShadowMaps");
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glUseProgram(program);
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    // inclinação + constante: evita acne sem descolar a sombra do objeto
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(2.0f, 4.0f);
+
+    int rendered = 0;
+
+    // Cascatas centradas na câmera, com o centro preso a uma grade de 1/8 da largura:
+    // só mudam quando a câmera anda bastante, e o encaixe em texels evita tremulação
+    glm::vec3 direction = snapshot.dirLight.direction;
+    glm::mat4 lightView = glm::lookAt(-direction * kSunDistance, glm::vec3(0.0f), UpFor(direction));
+    glm::vec4 cameraInLight = lightView * glm::vec4(snapshot.viewPos, 1.0f);
+    for (int i = 0; i < kCascades; i++) {
+        float half = kCascadeExtent[i] * 0.5f;
+        float step = kCascadeExtent[i] / 8.0f;
+        float cx = std::round(cameraInLight.x / step) * step;
+        float cy = std::round(cameraInLight.y / step) * step;
+        glm::mat4 projection = glm::ortho(cx - half, cx + half, cy - half, cy + half, 0.0f, 2.0f * kSunDistance);
+        cascadeTexel[i] = kCascadeExtent[i] / kSunMapSize;
+        if (RenderIfDirty(cascades[i], projection * lightView, sunTexture, i, kSunMapSize, snapshot, nullptr))
+            rendered++;
+    }
+
+    UpdateSpotSlots(snapshot);
+    for (size_t i = 0; i < snapshot.spotLights.size(); i++) {
+        int layer = spotLayers[i];
+        if (layer < 0)
+            continue;
+        const SpotLight& light = snapshot.spotLights[i];
+        // o cone externo mais uma folga, para o PCF da borda
+        float fov = std::min(2.0f * std::acos(light.outerCutOff) + glm::radians(5.0f), glm::radians(170.0f));
+        glm::mat4 view = glm::lookAt(light.position, light.position + light.direction, UpFor(light.direction));
+        glm::mat4 projection = glm::perspective(fov, 1.0f, 0.1f, kSpotRange);
+        // o próprio objeto da luz (corpo da lanterna, cabeça do gigante) não faz sombra nela
+        if (RenderIfDirty(spots[layer].map, projection * view, spotTexture, layer, kSpotMapSize, snapshot, light.owner))
+            rendered++;
+    }
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    return rendered;
+}
+
+// Cada luz mantém sua camada enquanto estiver ativa; luz apagada libera a camada
+// e ao acender de novo o mapa é refeito
+void ShadowMaps::UpdateSpotSlots(const FrameSnapshot& snapshot) {
+    spotLayers.assign(snapshot.spotLights.size(), -1);
+    bool claimed[kMaxSpotShadows] = {false, false, false, false};
+
+    for (size_t i = 0; i < snapshot.spotLights.size(); i++) {
+        const SpotLight& light = snapshot.spotLights[i];
+        for (int slot = 0; slot < kMaxSpotShadows; slot++) {
+            if (!claimed[slot] && spots[slot].owner == light.owner && spots[slot].material == light.material) {
+                claimed[slot] = true;
+                spotLayers[i] = slot;
+                break;
+            }
+        }
+    }
+    for (int slot = 0; slot < kMaxSpotShadows; slot++) {
+        if (!claimed[slot]) {
+            spots[slot].owner = nullptr;
+            spots[slot].map.valid = false;
+        }
+    }
+    for (size_t i = 0; i < snapshot.spotLights.size(); i++) {
+        if (spotLayers[i] >= 0)
+            continue;
+        for (int slot = 0; slot < kMaxSpotShadows; slot++) {
+            if (!claimed[slot]) {
+                claimed[slot] = true;
+                spots[slot].owner = snapshot.spotLights[i].owner;
+                spots[slot].material = snapshot.spotLights[i].material;
+                spotLayers[i] = slot;
+                break;
+            }
+        }
+    }
+}
+
+bool ShadowMaps::RenderIfDirty(CachedMap& cached, const glm::mat4& viewProjection, GLuint texture, int layer, int size,
+                               const FrameSnapshot& snapshot, const Object* exclude) {
+    std::vector<std::pair<const Object*, unsigned>> contributors;
+    std::vector<const ObjectDrawState*> draws;
+    for (const auto& state : snapshot.objects) {
+        if (state.object != exclude && BoxInFrustum(viewProjection, state.boundsMin, state.boundsMax)) {
+            contributors.push_back(std::make_pair(state.object, state.revision));
+            draws.push_back(&state);
+        }
+    }
+    std::sort(contributors.begin(), contributors.end());
+
+    if (cached.valid && cached.viewProjection == viewProjection && cached.contributors == contributors)
+        return false;
+
+    TRACE_SCOPE("ShadowMapRender");
+    cached.valid = true;
+    cached.viewProjection = viewProjection;
+    cached.contributors.swap(contributors);
+
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture, 0, layer);
+    glViewport(0, 0, size, size);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+    for (const ObjectDrawState* state : draws) {
+        state->object->DrawDepth(program, state->model);
+    }
+    return true;
+}
+
+void ShadowMaps::Bind(GLuint target) const {
+    glUseProgram(target);
+
+    // unidades 5 e 6: 0 é a textura do material e 0-4 o G-buffer
+    glActiveTexture(GL_TEXTURE5);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, sunTexture);
+    glUniform1i(glGetUniformLocation(target, "sunShadowMap"), 5);
+    glActiveTexture(GL_TEXTURE6);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, spotTexture);
+    glUniform1i(glGetUniformLocation(target, "spotShadowMap"), 6);
+    glActiveTexture(GL_TEXTURE0);
+
+    for (int i = 0; i < kCascades; i++) {
+        std::string index = "[" + std::to_string(i) + "]";
+        glUniformMatrix4fv(glGetUniformLocation(target, ("sunShadowMatrices" + index).c_str()), 1, GL_FALSE,
+                glm::value_ptr(cascades[i].viewProjection));
+        glUniform1f(glGetUniformLocation(target, ("sunShadowTexel" + index).c_str()), cascadeTexel[i]);
+    }
+    for (int i = 0; i < kMaxSpotShadows; i++) {
+        glUniformMatrix4fv(glGetUniformLocation(target, ("spotShadowMatrices[" + std::to_string(i) + "]").c_str()),
+                1, GL_FALSE, glm::value_ptr(spots[i].map.viewProjection));
+    }
+}
+
+ShadowMaps::~ShadowMaps() {
+    Destroy();
+}
+
+void ShadowMaps::Invalidate() {
+    for (auto& cascade : cascades) cascade.valid = false;
+    for (auto& spot : spots) spot.map.valid = false;
+}
+
+void ShadowMaps::Destroy() {
+    if (fbo) glDeleteFramebuffers(1, &fbo);
+    if (sunTexture) glDeleteTextures(1, &sunTexture);
+    if (spotTexture) glDeleteTextures(1, &spotTexture);
+    if (program) glDeleteProgram(program);
+    fbo = sunTexture = spotTexture = program = 0;
+    for (auto& cascade : cascades) cascade.valid = false;
+    for (auto& spot : spots) spot = SpotSlot();
+}
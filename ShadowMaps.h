@@ -0,0 +1,64 @@
+// ShadowMaps.h
+#ifndef SHADOW_MAPS_H
+#define SHADOW_MAPS_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <utility>
+#include <vector>
+#include "FrameSnapshot.h"
+
+// Shadow maps da luz direcional (cascatas em volta da câmera) e das spotlights ativas.
+// Cada mapa guarda os objetos que o afetam (com a revisão de cada um) e só é redesenhado
+// quando a luz, a cascata ou algum desses objetos mudou (Move/Scale/Rotate/ToggleLights).
+//   shadows.Update(snapshot);          redesenha os mapas sujos
+//   shadows.Bind(program);             uniforms/texturas de shadow.glsl (sem NO_SHADOWS)
+class ShadowMaps {
+public:
+    static const int kCascades = 3;       // SUN_CASCADES em shadow.glsl
+    static const int kMaxSpotShadows = 4; // MAX_SPOT_SHADOWS em shadow.glsl
+
+    ShadowMaps() = default;
+    ~ShadowMaps();
+    ShadowMaps(const ShadowMaps&) = delete;
+    ShadowMaps& operator=(const ShadowMaps&) = delete;
+
+    void Initialize();
+    void Destroy();
+    void ReloadProgram();  // hot reload de depth_vs/depth_fs; lança e mantém o atual se falhar
+
+    // Retorna quantos mapas foram redesenhados neste frame
+    int Update(const FrameSnapshot& snapshot);
+    void Bind(GLuint program) const;
+    // Todos os mapas são redesenhados no próximo Update (um mesh em streaming ganhou triângulos)
+    void Invalidate();
+    // Camada do mapa da spotlight snapshot.spotLights[index]; -1 sem sombra
+    int SpotLayer(size_t index) const { return index < spotLayers.size() ? spotLayers[index] : -1; }
+
+private:
+    struct CachedMap {
+        glm::mat4 viewProjection{1.0f};
+        std::vector<std::pair<const Object*, unsigned>> contributors;  // ordenados por ponteiro
+        bool valid{false};
+    };
+    struct SpotSlot {
+        CachedMap map;
+        const Object* owner{nullptr};  // luz identificada pelo objeto e índice do material
+        size_t material{0};
+    };
+
+    GLuint program{0};
+    GLuint fbo{0};
+    GLuint sunTexture{0}, spotTexture{0};  // GL_TEXTURE_2D_ARRAY de profundidade
+
+    CachedMap cascades[kCascades];
+    float cascadeTexel[kCascades]{0.0f, 0.0f, 0.0f};
+    SpotSlot spots[kMaxSpotShadows];
+    std::vector<int> spotLayers;
+
+    void UpdateSpotSlots(const FrameSnapshot& snapshot);
+    bool RenderIfDirty(CachedMap& cached, const glm::mat4& viewProjection, GLuint texture, int layer, int size,
+                       const FrameSnapshot& snapshot, const Object* exclude);
+};
+
+#endif
@@ -0,0 +1,52 @@
+// SkyPass.cpp
+#include "SkyPass.h"
+#include <glm/gtc/type_ptr.hpp>
+#include "Tracer.h"
+
+void SkyPass::Initialize(GLuint program) {
+    this->program = program;
+    glGenVertexArrays(1, &vao);
+}
+
+void SkyPass::SetProgram(GLuint program) {
+    if (this->program) glDeleteProgram(this->program);
+    this->program = program;
+}
+
+void SkyPass::Draw(const glm::mat4& view, const glm::mat4& projection, float rotation, const glm::vec3& tint) {
+    if (!texture)
+        return;
+
+    TRACE_SCOPE("SkyPass");
+    // só a rotação da câmera importa para a direção de visão
+    glm::mat4 rotationOnly = glm::mat4(glm::mat3(view));
+    glm::mat4 invViewProjection = glm::inverse(projection * rotationOnly);
+
+    glUseProgram(program);
+    glUniformMatrix4fv(glGetUniformLocation(program, "invViewProjection"), 1, GL_FALSE,
+            glm::value_ptr(invViewProjection));
+    glUniform1f(glGetUniformLocation(program, "rotation"), rotation);
+    glUniform3fv(glGetUniformLocation(program, "tint"), 1, glm::value_ptr(tint));
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glUniform1i(glGetUniformLocation(program, "skyTexture"), 0);
+
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_FALSE);
+    glBindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_LESS);
+}
+
+SkyPass::~SkyPass() {
+    Destroy();
+}
+
+void SkyPass::Destroy() {
+    if (vao) glDeleteVertexArrays(1, &vao);
+    if (program) glDeleteProgram(program);
+    vao = program = 0;
+    texture = 0;
+}
@@ -0,0 +1,31 @@
+// SkyPass.h
+#ifndef SKY_PASS_H
+#define SKY_PASS_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// Céu desenhado como um triângulo de tela cheia depois da geometria opaca,
+// amostrando uma textura equiretangular pela direção de visão.
+class SkyPass {
+public:
+    SkyPass() = default;
+    ~SkyPass();
+    SkyPass(const SkyPass&) = delete;
+    SkyPass& operator=(const SkyPass&) = delete;
+
+    void Initialize(GLuint program);   // assume o programa (fullscreen_vs.glsl/sky_fs.glsl)
+    void SetProgram(GLuint program);   // troca (hot reload) e apaga o anterior
+    void Destroy();                    // libera os objetos GL (antes de destruir o contexto)
+    void SetTexture(GLuint texture) { this->texture = texture; }
+    bool HasTexture() const { return texture != 0; }
+
+    void Draw(const glm::mat4& view, const glm::mat4& projection, float rotation, const glm::vec3& tint);
+
+private:
+    GLuint program{0};
+    GLuint vao{0};      // vazio: perfil core exige um VAO ligado mesmo sem atributos
+    GLuint texture{0};  // pertence ao TextureCache
+};
+
+#endif
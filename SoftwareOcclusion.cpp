@@ -0,0 +1,253 @@
+// SoftwareOcclusion.cpp
+#include "SoftwareOcclusion.h"
+#include <algorithm>
+#include <cmath>
+#include "Tracer.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Pixels lado a lado processados juntos; kTileWidth é múltiplo de todas as larguras
+#if defined(__AVX2__)
+typedef __m256 Lanes;
+typedef __m256 Mask;
+const int kLanes = 8;
+inline Lanes Splat(float v) { return _mm256_set1_ps(v); }
+inline Lanes Ramp() { return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+inline Lanes Add(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+inline Lanes Mul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+inline Lanes Min(Lanes a, Lanes b) { return _mm256_min_ps(a, b); }
+inline Lanes Load(const float* p) { return _mm256_loadu_ps(p); }
+inline void Store(float* p, Lanes v) { _mm256_storeu_ps(p, v); }
+inline Mask Inside(Lanes e0, Lanes e1, Lanes e2) {
+    return _mm256_cmp_ps(_mm256_min_ps(_mm256_min_ps(e0, e1), e2), _mm256_setzero_ps(), _CMP_GE_OQ);
+}
+inline bool Any(Mask m) { return _mm256_movemask_ps(m) != 0; }
+inline Lanes Select(Mask m, Lanes a, Lanes b) { return _mm256_blendv_ps(b, a, m); }
+#elif defined(__SSE2__)
+typedef __m128 Lanes;
+typedef __m128 Mask;
+const int kLanes = 4;
+inline Lanes Splat(float v) { return _mm_set1_ps(v); }
+inline Lanes Ramp() { return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+inline Lanes Add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+inline Lanes Mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+inline Lanes Min(Lanes a, Lanes b) { return _mm_min_ps(a, b); }
+inline Lanes Load(const float* p) { return _mm_loadu_ps(p); }
+inline void Store(float* p, Lanes v) { _mm_storeu_ps(p, v); }
+inline Mask Inside(Lanes e0, Lanes e1, Lanes e2) {
+    return _mm_cmpge_ps(_mm_min_ps(_mm_min_ps(e0, e1), e2), _mm_setzero_ps());
+}
+inline bool Any(Mask m) { return _mm_movemask_ps(m) != 0; }
+inline Lanes Select(Mask m, Lanes a, Lanes b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+#else
+typedef float Lanes;
+typedef bool Mask;
+const int kLanes = 1;
+inline Lanes Splat(float v) { return v; }
+inline Lanes Ramp() { return 0.0f; }
+inline Lanes Add(Lanes a, Lanes b) { return a + b; }
+inline Lanes Mul(Lanes a, Lanes b) { return a * b; }
+inline Lanes Min(Lanes a, Lanes b) { return std::min(a, b); }
+inline Lanes Load(const float* p) { return *p; }
+inline void Store(float* p, Lanes v) { *p = v; }
+inline Mask Inside(Lanes e0, Lanes e1, Lanes e2) { return e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f; }
+inline bool Any(Mask m) { return m; }
+inline Lanes Select(Mask m, Lanes a, Lanes b) { return m ? a : b; }
+#endif
+
+static_assert(SoftwareOcclusion::kTileWidth % kLanes == 0, "tile com número inteiro de grupos de pixels");
+
+// Distância assinada ao plano near em clip space (z = -w); >= 0 do lado visível
+float NearDistance(const glm::vec4& p) {
+    return p.z + p.w;
+}
+
+} // namespace
+
+SoftwareOcclusion::SoftwareOcclusion()
+        : bins(kTilesX * kTilesY), depth(kWidth * kHeight, 1.0f) {
+    std::fill(tileMax, tileMax + kTilesX * kTilesY, 1.0f);
+}
+
+void SoftwareOcclusion::Begin(const glm::mat4& viewProjection) {
+    this->viewProjection = viewProjection;
+    triangles.clear();
+    for (auto& bin : bins) bin.clear();
+}
+
+void SoftwareOcclusion::AddOccluder(const std::vector<glm::vec3>& vertices, const glm::mat4& model) {
+    glm::mat4 transform = viewProjection * model;
+    for (size_t i = 0; i + 2 < vertices.size(); i += 3) {
+        glm::vec4 in[3];
+        for (int k = 0; k < 3; k++) {
+            in[k] = transform * glm::vec4(vertices[i + k], 1.0f);
+        }
+
+        // Sutherland-Hodgman só contra o near: um triângulo vira 0, 1 ou 2
+        glm::vec4 out[4];
+        int count = 0;
+        for (int k = 0; k < 3; k++) {
+            const glm::vec4& a = in[k];
+            const glm::vec4& b = in[(k + 1) % 3];
+            float da = NearDistance(a), db = NearDistance(b);
+            if (da >= 0.0f)
+                out[count++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f))
+                out[count++] = a + (b - a) * (da / (da - db));
+        }
+        for (int k = 1; k + 1 < count; k++) {
+            AddTriangle(out[0], out[k], out[k + 1]);
+        }
+    }
+}
+
+void SoftwareOcclusion::AddTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) {
+    // clip space -> pixels do buffer (x, y) e profundidade de janela (z)
+    glm::vec3 v[3];
+    const glm::vec4* clip[3] = {&a, &b, &c};
+    for (int k = 0; k < 3; k++) {
+        float inverseW = 1.0f / clip[k]->w;
+        v[k] = glm::vec3((clip[k]->x * inverseW * 0.5f + 0.5f) * kWidth,
+                         (clip[k]->y * inverseW * 0.5f + 0.5f) * kHeight,
+                         clip[k]->z * inverseW * 0.5f + 0.5f);
+    }
+
+    // os dois lados contam: o proxy não precisa de winding consistente
+    float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+    if (std::abs(area) < 1e-6f)
+        return;
+    if (area < 0.0f) {
+        std::swap(v[1], v[2]);
+        area = -area;
+    }
+
+    Triangle triangle;
+    float minX = std::min({v[0].x, v[1].x, v[2].x}), maxX = std::max({v[0].x, v[1].x, v[2].x});
+    float minY = std::min({v[0].y, v[1].y, v[2].y}), maxY = std::max({v[0].y, v[1].y, v[2].y});
+    if (maxX < 0.0f || maxY < 0.0f || minX >= kWidth || minY >= kHeight)
+        return;
+    triangle.minX = std::max(static_cast<int>(std::floor(minX)), 0);
+    triangle.minY = std::max(static_cast<int>(std::floor(minY)), 0);
+    triangle.maxX = std::min(static_cast<int>(std::floor(maxX)), kWidth - 1);
+    triangle.maxY = std::min(static_cast<int>(std::floor(maxY)), kHeight - 1);
+
+    // aresta k vai de v[k] a v[k+1]; positiva dentro para a orientação anti-horária
+    for (int k = 0; k < 3; k++) {
+        const glm::vec3& from = v[k];
+        const glm::vec3& to = v[(k + 1) % 3];
+        triangle.edgeA[k] = from.y - to.y;
+        triangle.edgeB[k] = to.x - from.x;
+        triangle.edgeC[k] = -(triangle.edgeA[k] * from.x + triangle.edgeB[k] * from.y);
+    }
+    // z é afim em x, y na tela
+    float dzdx = ((v[1].z - v[0].z) * (v[2].y - v[0].y) - (v[2].z - v[0].z) * (v[1].y - v[0].y)) / area;
+    float dzdy = ((v[2].z - v[0].z) * (v[1].x - v[0].x) - (v[1].z - v[0].z) * (v[2].x - v[0].x)) / area;
+    triangle.depthA = dzdx;
+    triangle.depthB = dzdy;
+    triangle.depthC = v[0].z - dzdx * v[0].x - dzdy * v[0].y;
+
+    unsigned index = static_cast<unsigned>(triangles.size());
+    triangles.push_back(triangle);
+    for (int ty = triangle.minY / kTileHeight; ty <= triangle.maxY / kTileHeight; ty++) {
+        for (int tx = triangle.minX / kTileWidth; tx <= triangle.maxX / kTileWidth; tx++) {
+            bins[ty * kTilesX + tx].push_back(index);
+        }
+    }
+}
+
+void SoftwareOcclusion::Rasterize() {
+    TRACE_SCOPE("SoftwareOcclusion");
+    for (int ty = 0; ty < kTilesY; ty++) {
+        for (int tx = 0; tx < kTilesX; tx++) {
+            RasterizeTile(tx, ty);
+        }
+    }
+}
+
+void SoftwareOcclusion::RasterizeTile(int tileX, int tileY) {
+    int left = tileX * kTileWidth, bottom = tileY * kTileHeight;
+    for (int y = bottom; y < bottom + kTileHeight; y++) {
+        std::fill(&depth[y * kWidth + left], &depth[y * kWidth + left] + kTileWidth, 1.0f);
+    }
+
+    const Lanes ramp = Ramp();
+    for (unsigned index : bins[tileY * kTilesX + tileX]) {
+        const Triangle& t = triangles[index];
+        // começa num grupo inteiro; pixels fora da caixa do triângulo caem fora das arestas
+        int x0 = left + (std::max(t.minX - left, 0) / kLanes) * kLanes;
+        int x1 = std::min(t.maxX, left + kTileWidth - 1);
+        int y0 = std::max(t.minY, bottom), y1 = std::min(t.maxY, bottom + kTileHeight - 1);
+
+        Lanes a0 = Splat(t.edgeA[0]), a1 = Splat(t.edgeA[1]), a2 = Splat(t.edgeA[2]);
+        Lanes depthA = Splat(t.depthA);
+        for (int y = y0; y <= y1; y++) {
+            float py = y + 0.5f;
+            Lanes row0 = Splat(t.edgeB[0] * py + t.edgeC[0]);
+            Lanes row1 = Splat(t.edgeB[1] * py + t.edgeC[1]);
+            Lanes row2 = Splat(t.edgeB[2] * py + t.edgeC[2]);
+            Lanes rowDepth = Splat(t.depthB * py + t.depthC);
+            float* line = &depth[y * kWidth];
+            for (int x = x0; x <= x1; x += kLanes) {
+                Lanes px = Add(Splat(x + 0.5f), ramp);
+                Mask inside = Inside(Add(Mul(a0, px), row0), Add(Mul(a1, px), row1), Add(Mul(a2, px), row2));
+                if (!Any(inside))
+                    continue;
+                Lanes current = Load(line + x);
+                Store(line + x, Select(inside, Min(current, Add(Mul(depthA, px), rowDepth)), current));
+            }
+        }
+    }
+
+    float farthest = 0.0f;
+    for (int y = bottom; y < bottom + kTileHeight; y++) {
+        const float* line = &depth[y * kWidth + left];
+        farthest = std::max(farthest, *std::max_element(line, line + kTileWidth));
+    }
+    tileMax[tileY * kTilesX + tileX] = farthest;
+}
+
+bool SoftwareOcclusion::IsOccluded(const glm::vec3& lo, const glm::vec3& hi) const {
+    if (triangles.empty())
+        return false;
+
+    float minX = kWidth, minY = kHeight, maxX = 0.0f, maxY = 0.0f;
+    float nearest = 1.0f;
+    for (int i = 0; i < 8; i++) {
+        glm::vec4 p = viewProjection * glm::vec4((i & 1) ? hi.x : lo.x, (i & 2) ? hi.y : lo.y, (i & 4) ? hi.z : lo.z, 1.0f);
+        // atravessa o plano da câmera: fica visível
+        if (p.w <= 1e-4f)
+            return false;
+        float x = (p.x / p.w * 0.5f + 0.5f) * kWidth, y = (p.y / p.w * 0.5f + 0.5f) * kHeight;
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+        nearest = std::min(nearest, p.z / p.w * 0.5f + 0.5f);
+    }
+    // fora da tela: o frustum culling é quem decide
+    if (maxX < 0.0f || maxY < 0.0f || minX >= kWidth || minY >= kHeight)
+        return false;
+
+    int firstX = std::max(static_cast<int>(std::floor(minX)), 0), lastX = std::min(static_cast<int>(maxX), kWidth - 1);
+    int firstY = std::max(static_cast<int>(std::floor(minY)), 0), lastY = std::min(static_cast<int>(maxY), kHeight - 1);
+    for (int ty = firstY / kTileHeight; ty <= lastY / kTileHeight; ty++) {
+        for (int tx = firstX / kTileWidth; tx <= lastX / kTileWidth; tx++) {
+            // tile inteiro na frente da caixa: nem olha os pixels
+            if (tileMax[ty * kTilesX + tx] < nearest)
+                continue;
+            int x0 = std::max(firstX, tx * kTileWidth), x1 = std::min(lastX, (tx + 1) * kTileWidth - 1);
+            int y0 = std::max(firstY, ty * kTileHeight), y1 = std::min(lastY, (ty + 1) * kTileHeight - 1);
+            for (int y = y0; y <= y1; y++) {
+                for (int x = x0; x <= x1; x++) {
+                    if (depth[y * kWidth + x] >= nearest)
+                        return false;
+                }
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,51 @@
+// SoftwareOcclusion.h
+#ifndef SOFTWARE_OCCLUSION_H
+#define SOFTWARE_OCCLUSION_H
+
+#include <glm/glm.hpp>
+#include <vector>
+
+// Oclusão sem GPU: os proxies dos oclusores (Mesh::occluder) são rasterizados só em profundidade
+// num buffer pequeno na CPU, com o frame atual, e as AABBs dos outros objetos são testadas contra ele.
+// O buffer é dividido em tiles: cada triângulo vai para a lista dos tiles que sua caixa toca, cada
+// tile é rasterizado de uma vez (SSE2, ou AVX2 com make NATIVE=1) e guarda a maior profundidade
+// para o teste recusar cedo. Não usa nada de GL; roda na simulação.
+//   occlusion.Begin(projection * view);
+//   occlusion.AddOccluder(mesh.occluder, model);   para cada oclusor
+//   occlusion.Rasterize();
+//   occlusion.IsOccluded(min, max);                para cada objeto
+class SoftwareOcclusion {
+public:
+    static const int kWidth = 320, kHeight = 192;
+    static const int kTileWidth = 32, kTileHeight = 16;
+    static const int kTilesX = kWidth / kTileWidth, kTilesY = kHeight / kTileHeight;
+
+    SoftwareOcclusion();
+
+    void Begin(const glm::mat4& viewProjection);
+    // Sopa de triângulos (3 posições cada) em coordenadas do modelo; recorta no plano near
+    void AddOccluder(const std::vector<glm::vec3>& triangles, const glm::mat4& model);
+    void Rasterize();
+    // Sem oclusores no frame nada é ocluído
+    bool IsOccluded(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+    size_t TriangleCount() const { return triangles.size(); }
+
+private:
+    // Já em pixels do buffer: arestas e profundidade como planos a*x + b*y + c
+    struct Triangle {
+        float edgeA[3], edgeB[3], edgeC[3];
+        float depthA, depthB, depthC;
+        int minX, minY, maxX, maxY;
+    };
+
+    glm::mat4 viewProjection{1.0f};
+    std::vector<Triangle> triangles;
+    std::vector<std::vector<unsigned>> bins;  // índices em triangles por tile
+    std::vector<float> depth;                 // profundidade de janela [0, 1], linha 0 embaixo
+    float tileMax[kTilesX * kTilesY];
+
+    void AddTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+    void RasterizeTile(int tileX, int tileY);
+};
+
+#endif
@@ -0,0 +1,395 @@
+// TextureCache.cpp
+#include "TextureCache.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "Tracer.h"
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+namespace {
+
+const int kStreamInitialSize = 128;  // maior dimensão residente na carga
+const unsigned kIdleFrames = 300;   // sem pedidos por ~5 s: volta ao nível da carga
+const size_t kMaxDecodes = 2;       // threads de decodificação ao mesmo tempo
+const int kUploadsPerFrame = 1;     // uma 4K com mips já são ~85 MB pelo barramento
+
+int Dimension(int size, int level) {
+    return std::max(1, size >> level);
+}
+
+// VRAM do nível com a cadeia de mips abaixo dele (+1/3)
+size_t LevelBytes(int width, int height, int level) {
+    return static_cast<size_t>(Dimension(width, level)) * Dimension(height, level) * 4 * 4 / 3;
+}
+
+int LevelForSize(int width, int height, int maxSize) {
+    int level = 0;
+    while (std::max(Dimension(width, level), Dimension(height, level)) > maxSize)
+        level++;
+    return level;
+}
+
+// Metade da largura e da altura, média de 2x2 (a última coluna/linha ímpar fica de fora)
+DecodedImage Halve(const DecodedImage& image) {
+    DecodedImage half = image;
+    half.width = Dimension(image.width, 1);
+    half.height = Dimension(image.height, 1);
+    half.level = image.level + 1;
+    int channels = image.channels;
+    // malloc: stbi_image_free é o free padrão
+    half.pixels = static_cast<unsigned char*>(malloc(static_cast<size_t>(half.width) * half.height * channels));
+    for (int y = 0; y < half.height; y++) {
+        const unsigned char* row0 = image.pixels + static_cast<size_t>(std::min(2 * y, image.height - 1)) * image.width * channels;
+        const unsigned char* row1 = image.pixels + static_cast<size_t>(std::min(2 * y + 1, image.height - 1)) * image.width * channels;
+        unsigned char* out = half.pixels + static_cast<size_t>(y) * half.width * channels;
+        for (int x = 0; x < half.width; x++) {
+            int x0 = std::min(2 * x, image.width - 1) * channels;
+            int x1 = std::min(2 * x + 1, image.width - 1) * channels;
+            for (int c = 0; c < channels; c++) {
+                out[x * channels + c] = static_cast<unsigned char>(
+                        (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+            }
+        }
+    }
+    return half;
+}
+
+// Nova imagem no nível pedido (cópia se já está nele); a original não muda
+DecodedImage Reduce(const DecodedImage& image, int level) {
+    if (level <= image.level) {
+        DecodedImage copy = image;
+        size_t size = static_cast<size_t>(image.width) * image.height * image.channels;
+        copy.pixels = static_cast<unsigned char*>(malloc(size));
+        memcpy(copy.pixels, image.pixels, size);
+        return copy;
+    }
+    DecodedImage reduced = Halve(image);
+    while (reduced.level < level) {
+        DecodedImage next = Halve(reduced);
+        TextureCache::Free(reduced);
+        reduced = next;
+    }
+    return reduced;
+}
+
+} // namespace
+
+TextureCache::~TextureCache() {
+    Clear();
+}
+
+DecodedImage TextureCache::Decode(const std::string& path) {
+    TRACE_SCOPE_DETAIL("DecodeTexture", path.c_str());
+    DecodedImage image;
+    image.pixels = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0);
+    image.sourceWidth = image.width;
+    image.sourceHeight = image.height;
+    return image;
+}
+
+DecodedImage TextureCache::DecodeStreamed(const std::string& path, int level, int maxSize) {
+    DecodedImage image = Decode(path);
+    if (!image.pixels)
+        return image;
+    if (maxSize > 0)
+        level = LevelForSize(image.width, image.height, maxSize);
+    if (level <= 0)
+        return image;
+    TRACE_SCOPE_DETAIL("ReduceTexture", path.c_str());
+    DecodedImage reduced = Reduce(image, level);
+    Free(image);
+    return reduced;
+}
+
+void TextureCache::Upload(const DecodedImage& image, GLuint texture) {
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // linhas RGB de largura ímpar não são alinhadas em 4 bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    GLenum format = image.channels == 4 ? GL_RGBA : GL_RGB;
+    glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels);
+}
+
+void TextureCache::UploadMipmapped(const DecodedImage& image, GLuint texture) {
+    Upload(image, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    // o nível 0 pode ter mudado de tamanho: a cadeia toda é refeita
+    glGenerateMipmap(GL_TEXTURE_2D);
+}
+
+void TextureCache::Free(DecodedImage& image) {
+    stbi_image_free(image.pixels);
+    image.pixels = nullptr;
+}
+
+void TextureCache::EnableStreaming(size_t budgetBytes) {
+    streaming = true;
+    budget = budgetBytes;
+}
+
+void TextureCache::Prefetch(const std::string& path, bool stream) {
+    if (entries.count(path))
+        return;
+
+    stbi_set_flip_vertically_on_load(true);
+    Entry& entry = entries[path];
+    entry.streamed = streaming && stream;
+    if (entry.streamed)
+        entry.decoded = std::async(std::launch::async, DecodeStreamed, path, 0, kStreamInitialSize).share();
+    else
+        entry.decoded = std::async(std::launch::async, Decode, path).share();
+}
+
+GLuint TextureCache::Get(const std::string& path, bool stream) {
+    Prefetch(path, stream);
+    auto it = entries.find(path);
+    Entry& entry = it->second;
+    if (entry.texture)
+        return entry.texture;
+
+    TRACE_SCOPE_DETAIL("LoadTexture", path.c_str());
+    DecodedImage image = entry.decoded.get();
+    if (!image.pixels) {
+        std::cerr << "Failed to load texture: " << path << " (usando textura substituta)" << std::endl;
+        entry.texture = Fallback();
+        return entry.texture;
+    }
+
+    std::cout << path << (image.channels == 4 ? " RGBA" : " RGB");
+    if (entry.streamed)
+        std::cout << " (streaming " << image.sourceWidth << "x" << image.sourceHeight << " from "
+                  << image.width << "x" << image.height << ")";
+    std::cout << std::endl;
+    glGenTextures(1, &entry.texture);
+    if (entry.streamed) {
+        entry.sourceWidth = image.sourceWidth;
+        entry.sourceHeight = image.sourceHeight;
+        entry.lowestLevel = image.level;
+        streamedTextures[entry.texture] = it;
+        Adopt(it, image);
+        return entry.texture;
+    }
+    Upload(image, entry.texture);
+    entry.bytes = static_cast<size_t>(image.width) * image.height * 4;
+    stbi_image_free(image.pixels);
+    return entry.texture;
+}
+
+// Envia uma imagem já no nível do streaming, que passa a ser o residente, e a libera
+void TextureCache::Adopt(EntryIterator it, DecodedImage& image) {
+    Entry& entry = it->second;
+    TRACE_SCOPE_DETAIL("StreamTexture", it->first.c_str());
+    UploadMipmapped(image, entry.texture);
+    entry.residentLevel = image.level;
+    entry.targetLevel = image.level;
+    entry.bytes = LevelBytes(image.width, image.height, 0);
+    Free(image);
+}
+
+bool TextureCache::Replace(const std::string& path, const DecodedImage& image) {
+    auto it = entries.find(path);
+    if (it == entries.end() || !it->second.texture || it->second.texture == fallback)
+        return false;
+
+    TRACE_SCOPE_DETAIL("ReloadTexture", path.c_str());
+    Entry& entry = it->second;
+    if (entry.streamed) {
+        // o arquivo pode ter mudado de tamanho: mesmo nível residente, limitado ao da carga
+        entry.sourceWidth = image.width;
+        entry.sourceHeight = image.height;
+        entry.lowestLevel = LevelForSize(image.width, image.height, kStreamInitialSize);
+        DecodedImage reduced = Reduce(image, std::min(entry.residentLevel, entry.lowestLevel));
+        Adopt(it, reduced);
+        return true;
+    }
+    Upload(image, entry.texture);
+    entry.bytes = static_cast<size_t>(image.width) * image.height * 4;
+    return true;
+}
+
+size_t TextureCache::TextureBytes(GLuint texture) const {
+    if (texture && texture == fallback)
+        return 4;
+    for (const auto& entry : entries) {
+        if (entry.second.texture == texture && texture != fallback)
+            return entry.second.bytes;
+    }
+    return 0;
+}
+
+// Nível cujo texel ainda cobre no máximo um pixel (o que o filtro trilinear escolheria)
+int TextureCache::LevelFor(const Entry& entry, float uvPerPixel) const {
+    float texelsPerPixel = uvPerPixel * std::max(entry.sourceWidth, entry.sourceHeight);
+    if (!(texelsPerPixel > 1.0f))
+        return 0;
+    return static_cast<int>(std::min(std::log2(texelsPerPixel), static_cast<float>(entry.lowestLevel)));
+}
+
+void TextureCache::RequestDetail(GLuint texture, float uvPerPixel) {
+    auto found = streamedTextures.find(texture);
+    if (found == streamedTextures.end())
+        return;
+    Entry& entry = found->second->second;
+    // frame + 1: o que UpdateStreaming vai processar
+    if (entry.lastUsed != frame + 1 || uvPerPixel < entry.uvPerPixel)
+        entry.uvPerPixel = uvPerPixel;
+    entry.lastUsed = frame + 1;
+}
+
+void TextureCache::UpdateStreaming() {
+    if (!streaming)
+        return;
+    TRACE_SCOPE("TextureCache::UpdateStreaming");
+    frame++;
+
+    // o que cada textura quer: sobe com o uso; só desce parada há kIdleFrames ou pelo orçamento
+    size_t total = 0;
+    for (auto& texture : streamedTextures) {
+        Entry& entry = texture.second->second;
+        if (entry.stuck)
+            entry.targetLevel = entry.residentLevel;
+        else if (entry.lastUsed == frame)
+            entry.targetLevel = std::min(LevelFor(entry, entry.uvPerPixel), entry.residentLevel);
+        else if (frame - entry.lastUsed >= kIdleFrames)
+            entry.targetLevel = entry.lowestLevel;
+        else
+            entry.targetLevel = entry.residentLevel;
+        total += LevelBytes(entry.sourceWidth, entry.sourceHeight, entry.targetLevel);
+    }
+    // acima do orçamento: a maior desce um nível por vez (empate: a usada há mais tempo)
+    while (total > budget) {
+        Entry* largest = nullptr;
+        size_t largestBytes = 0;
+        for (auto& texture : streamedTextures) {
+            Entry& entry = texture.second->second;
+            if (entry.targetLevel >= entry.lowestLevel || entry.stuck)
+                continue;
+            size_t bytes = LevelBytes(entry.sourceWidth, entry.sourceHeight, entry.targetLevel);
+            if (bytes > largestBytes || (bytes == largestBytes && largest && entry.lastUsed < largest->lastUsed)) {
+                largest = &entry;
+                largestBytes = bytes;
+            }
+        }
+        if (!largest)
+            break;  // tudo no nível da carga: o orçamento é menor que o mínimo
+        largest->targetLevel++;
+        total -= largestBytes;
+        total += LevelBytes(largest->sourceWidth, largest->sourceHeight, largest->targetLevel);
+    }
+
+    // prontas: no máximo kUploadsPerFrame por frame
+    int uploads = 0;
+    for (auto& texture : streamedTextures) {
+        Entry& entry = texture.second->second;
+        if (uploads == kUploadsPerFrame)
+            break;
+        if (!entry.pending.valid() || entry.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            continue;
+        DecodedImage image = entry.pending.get();
+        if (!image.pixels) {
+            std::cerr << "Failed to stream texture: " << texture.second->first << " (mantendo o nível atual)" << std::endl;
+            entry.stuck = true;
+            continue;
+        }
+        int target = entry.targetLevel;
+        Adopt(texture.second, image);
+        entry.targetLevel = target;
+        uploads++;
+    }
+
+    // novas decodificações: primeiro as que liberam VRAM, depois as que mais sobem de nível
+    std::vector<EntryIterator> changes;
+    size_t decoding = 0;
+    for (auto& texture : streamedTextures) {
+        Entry& entry = texture.second->second;
+        if (entry.pending.valid())
+            decoding++;
+        else if (entry.targetLevel != entry.residentLevel)
+            changes.push_back(texture.second);
+    }
+    std::sort(changes.begin(), changes.end(), [](const EntryIterator& a, const EntryIterator& b) {
+        return a->second.targetLevel - a->second.residentLevel > b->second.targetLevel - b->second.residentLevel;
+    });
+    std::stable_partition(changes.begin(), changes.end(), [](const EntryIterator& it) {
+        return it->second.targetLevel > it->second.residentLevel;
+    });
+    for (auto& it : changes) {
+        if (decoding == kMaxDecodes)
+            break;
+        it->second.pending = std::async(std::launch::async, DecodeStreamed, it->first, it->second.targetLevel, 0);
+        decoding++;
+    }
+}
+
+void TextureCache::LoadFull(GLuint texture) {
+    auto found = streamedTextures.find(texture);
+    if (found == streamedTextures.end() || found->second->second.residentLevel == 0)
+        return;
+    Entry& entry = found->second->second;
+    if (entry.pending.valid()) {
+        DecodedImage image = entry.pending.get();
+        Free(image);
+    }
+    DecodedImage image = DecodeStreamed(found->second->first, 0, 0);
+    if (image.pixels)
+        Adopt(found->second, image);
+}
+
+size_t TextureCache::StreamedBytes() const {
+    size_t total = 0;
+    for (const auto& texture : streamedTextures)
+        total += texture.second->second.bytes;
+    return total;
+}
+
+size_t TextureCache::PendingStreams() const {
+    size_t count = 0;
+    for (const auto& texture : streamedTextures)
+        count += texture.second->second.pending.valid();
+    return count;
+}
+
+GLuint TextureCache::Fallback() {
+    if (!fallback) {
+        const unsigned char grey[3] = {128, 128, 128};
+        DecodedImage image;
+        image.width = image.height = 1;
+        image.channels = 3;
+        image.pixels = const_cast<unsigned char*>(grey);
+
+        glGenTextures(1, &fallback);
+        Upload(image, fallback);
+    }
+    return fallback;
+}
+
+void TextureCache::Clear() {
+    for (auto& entry : entries) {
+        if (entry.second.pending.valid()) {
+            DecodedImage image = entry.second.pending.get();
+            stbi_image_free(image.pixels);
+        }
+        if (!entry.second.texture) {
+            // decodificação nunca consumida: espera e libera
+            DecodedImage image = entry.second.decoded.get();
+            stbi_image_free(image.pixels);
+        } else if (entry.second.texture != fallback) {
+            glDeleteTextures(1, &entry.second.texture);
+        }
+    }
+    entries.clear();
+    streamedTextures.clear();
+
+    if (fallback) glDeleteTextures(1, &fallback);
+    fallback = 0;
+}
@@ -0,0 +1,92 @@
+// TextureCache.h
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <GL/glew.h>
+#include <future>
+#include <map>
+#include <string>
+
+struct DecodedImage {
+    int width{0}, height{0}, channels{0};
+    unsigned char* pixels{nullptr};  // liberado por stbi_image_free
+    int level{0};                    // streaming: o arquivo reduzido à metade level vezes
+    int sourceWidth{0}, sourceHeight{0};  // tamanho no arquivo (nível 0)
+};
+
+// Texturas compartilhadas por caminho: cada arquivo é decodificado e enviado à GPU uma única vez.
+// Prefetch decodifica em uma thread de trabalho; Get precisa do contexto GL.
+// Streaming (EnableStreaming antes do primeiro Prefetch): cada textura entra só com os mips de até
+// 128 texels e sobe de resolução conforme a renderização informa o uso de cada frame
+// (RequestDetail). Os níveis maiores são decodificados de novo do arquivo em threads de trabalho e
+// enviados por UpdateStreaming; acima do orçamento de VRAM as maiores descem de nível. O id GL não
+// muda, então Object continua com as mesmas texturas.
+class TextureCache {
+public:
+    TextureCache() = default;
+    ~TextureCache();
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    void EnableStreaming(size_t budgetBytes);
+    bool Streaming() const { return streaming; }
+    // stream = false: textura inteira, fora do orçamento (o céu, que não tem como informar o uso).
+    // Vale o primeiro pedido de cada caminho
+    void Prefetch(const std::string& path, bool stream = true);
+    GLuint Get(const std::string& path, bool stream = true);   // textura substituta se o arquivo falhar
+    GLuint Fallback();
+    // Reenvia a imagem para a mesma textura GL (quem guardou o id continua válido).
+    // Falso se o caminho não tem textura própria (nunca carregou ou usa a substituta).
+    bool Replace(const std::string& path, const DecodedImage& image);
+    // Estimativa da VRAM da textura (4 bytes por texel, como o driver guarda RGB8); 0 se não é do cache
+    size_t TextureBytes(GLuint texture) const;
+    void Clear();
+
+    // Thread de render, a cada frame: uvPerPixel é quanto de uv cabe em um pixel onde a textura
+    // apareceu (vale o menor pedido); ids fora do streaming são ignorados
+    void RequestDetail(GLuint texture, float uvPerPixel);
+    // Depois dos pedidos do frame: escolhe os níveis dentro do orçamento, dispara as decodificações
+    // e envia as que ficaram prontas
+    void UpdateStreaming();
+    // Carga síncrona do nível 0 (os impostores assam com a textura inteira); o uso decide depois
+    void LoadFull(GLuint texture);
+    size_t StreamedBytes() const;       // VRAM das texturas em streaming
+    size_t PendingStreams() const;      // decodificações em andamento
+
+    static DecodedImage Decode(const std::string& path);
+    // Decodifica e reduz ao nível pedido; com maxSize > 0, ao primeiro nível que cabe em maxSize
+    static DecodedImage DecodeStreamed(const std::string& path, int level, int maxSize);
+    static void Upload(const DecodedImage& image, GLuint texture);
+    // Com a cadeia de mips (glGenerateMipmap) e filtro trilinear
+    static void UploadMipmapped(const DecodedImage& image, GLuint texture);
+    static void Free(DecodedImage& image);
+
+private:
+    struct Entry {
+        std::shared_future<DecodedImage> decoded;
+        GLuint texture{0};
+        size_t bytes{0};
+        // streaming
+        bool streamed{false};
+        int sourceWidth{0}, sourceHeight{0};
+        int lowestLevel{0};    // o da carga: a resolução nunca fica menor que essa
+        int residentLevel{0};
+        int targetLevel{0};
+        float uvPerPixel{0.0f};
+        unsigned lastUsed{0};  // frame do último RequestDetail
+        bool stuck{false};     // uma decodificação do streaming falhou: fica o nível atual
+        std::future<DecodedImage> pending;
+    };
+    using EntryIterator = std::map<std::string, Entry>::iterator;
+    std::map<std::string, Entry> entries;
+    std::map<GLuint, EntryIterator> streamedTextures;
+    GLuint fallback{0};
+    bool streaming{false};
+    size_t budget{0};
+    unsigned frame{0};
+
+    void Adopt(EntryIterator it, DecodedImage& image);
+    int LevelFor(const Entry& entry, float uvPerPixel) const;
+};
+
+#endif
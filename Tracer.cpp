@@ -0,0 +1,153 @@
+// Tracer.cpp
+#include "Tracer.h"
+
+#ifdef ENABLE_TRACING
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+constexpr size_t kBlockSize = 1024;
+
+// Bloco de eventos de uma thread. Só a thread dona escreve; o count é publicado com release
+// para que WriteChromeTrace leia eventos completos.
+struct TraceBlock {
+    TraceEvent events[kBlockSize];
+    std::atomic<size_t> count{0};
+    std::atomic<TraceBlock*> next{nullptr};
+};
+
+struct ThreadBuffer {
+    uint32_t tid{0};
+    char name[32]{};
+    TraceBlock* head{nullptr};
+    TraceBlock* tail{nullptr};
+    std::atomic<ThreadBuffer*> next{nullptr};
+};
+
+std::atomic<ThreadBuffer*> g_buffers{nullptr};
+std::atomic<uint32_t> g_nextTid{1};
+
+std::chrono::steady_clock::time_point Origin() {
+    static const auto origin = std::chrono::steady_clock::now();
+    return origin;
+}
+
+// Os buffers nunca são liberados: eles precisam sobreviver às threads para serem exportados no fim.
+ThreadBuffer* LocalBuffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        buffer = new ThreadBuffer();
+        buffer->tid = g_nextTid.fetch_add(1, std::memory_order_relaxed);
+        buffer->head = buffer->tail = new TraceBlock();
+
+        ThreadBuffer* old = g_buffers.load(std::memory_order_relaxed);
+        do {
+            buffer->next.store(old, std::memory_order_relaxed);
+        } while (!g_buffers.compare_exchange_weak(old, buffer, std::memory_order_release,
+                                                  std::memory_order_relaxed));
+    }
+    return buffer;
+}
+
+void WriteEscaped(FILE* out, const char* s) {
+    for (; *s; s++) {
+        unsigned char c = static_cast<unsigned char>(*s);
+        if (c == '"' || c == '\\') {
+            fputc('\\', out);
+            fputc(c, out);
+        } else if (c < 0x20) {
+            fprintf(out, "\\u%04x", c);
+        } else {
+            fputc(c, out);
+        }
+    }
+}
+
+} // namespace
+
+uint64_t Tracer::Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - Origin()).count();
+}
+
+void Tracer::Record(const char* name, const char* detail, uint64_t start, uint64_t end) {
+    ThreadBuffer* buffer = LocalBuffer();
+    TraceBlock* block = buffer->tail;
+    size_t n = block->count.load(std::memory_order_relaxed);
+    if (n == kBlockSize) {
+        TraceBlock* fresh = new TraceBlock();
+        block->next.store(fresh, std::memory_order_release);
+        buffer->tail = block = fresh;
+        n = 0;
+    }
+
+    TraceEvent& ev = block->events[n];
+    ev.name = name;
+    ev.start = start;
+    ev.end = end;
+    if (detail) {
+        strncpy(ev.detail, detail, sizeof(ev.detail) - 1);
+        ev.detail[sizeof(ev.detail) - 1] = '\0';
+    } else {
+        ev.detail[0] = '\0';
+    }
+    block->count.store(n + 1, std::memory_order_release);
+}
+
+void Tracer::SetThreadName(const char* name) {
+    ThreadBuffer* buffer = LocalBuffer();
+    strncpy(buffer->name, name, sizeof(buffer->name) - 1);
+}
+
+bool Tracer::WriteChromeTrace(const char* path) {
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        std::cerr << "Cannot write trace file: " << path << std::endl;
+        return false;
+    }
+
+    size_t total = 0;
+    bool first = true;
+    fputs("{\"traceEvents\":[\n", out);
+    for (ThreadBuffer* buffer = g_buffers.load(std::memory_order_acquire); buffer;
+         buffer = buffer->next.load(std::memory_order_relaxed)) {
+        if (buffer->name[0]) {
+            fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"",
+                    first ? "" : ",\n", buffer->tid);
+            WriteEscaped(out, buffer->name);
+            fputs("\"}}", out);
+            first = false;
+        }
+
+        for (TraceBlock* block = buffer->head; block; block = block->next.load(std::memory_order_acquire)) {
+            size_t count = block->count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < count; i++) {
+                const TraceEvent& ev = block->events[i];
+                fprintf(out, "%s{\"name\":\"", first ? "" : ",\n");
+                WriteEscaped(out, ev.name);
+                fprintf(out, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+                        buffer->tid, ev.start / 1000.0, (ev.end - ev.start) / 1000.0);
+                if (ev.detail[0]) {
+                    fputs(",\"args\":{\"detail\":\"", out);
+                    WriteEscaped(out, ev.detail);
+                    fputs("\"}", out);
+                }
+                fputc('}', out);
+                first = false;
+                total++;
+            }
+        }
+    }
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", out);
+    fclose(out);
+
+    std::cout << "Trace: " << total << " eventos escritos em " << path << std::endl;
+    return true;
+}
+
+#endif
@@ -0,0 +1,65 @@
+// Tracer.h
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <cstdint>
+
+// Tracer de zonas com escopo (exportado no formato Chrome trace-event, abra em chrome://tracing).
+// Compilado apenas com -DENABLE_TRACING (make TRACE=1); sem a flag as macros viram no-op.
+//
+//   TRACE_SCOPE("RenderFrame");             nome precisa ser literal/estático
+//   TRACE_SCOPE_DETAIL("LoadOBJ", path);    detalhe é copiado (truncado) para o evento
+//
+// Cada thread grava em um buffer próprio (thread_local), sem locks no caminho quente.
+
+#ifdef ENABLE_TRACING
+
+struct TraceEvent {
+    const char* name;
+    uint64_t start;  // ns desde o início do processo
+    uint64_t end;
+    char detail[48];
+};
+
+class Tracer {
+public:
+    static uint64_t Now();
+    static void Record(const char* name, const char* detail, uint64_t start, uint64_t end);
+    static void SetThreadName(const char* name);
+    static bool WriteChromeTrace(const char* path);
+};
+
+class TraceZone {
+public:
+    explicit TraceZone(const char* name, const char* detail = nullptr)
+        : name(name), detail(detail), start(Tracer::Now()) {}
+    ~TraceZone() { Tracer::Record(name, detail, start, Tracer::Now()); }
+
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+private:
+    const char* name;
+    const char* detail;
+    uint64_t start;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceZone TRACE_CONCAT(traceZone_, __LINE__)(name)
+#define TRACE_SCOPE_DETAIL(name, detail) TraceZone TRACE_CONCAT(traceZone_, __LINE__)(name, detail)
+
+#else
+
+class Tracer {
+public:
+    static uint64_t Now() { return 0; }
+    static void SetThreadName(const char*) {}
+    static bool WriteChromeTrace(const char*) { return false; }
+};
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_SCOPE_DETAIL(name, detail) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,114 @@
+// parse_bench.cpp
+// Microbenchmark dos números das linhas v/vt/vn dos .obj: extração com iostream (o loader antigo),
+// strtof e ParseFloat (FloatParser.h). Confere bit a bit ParseFloat contra strtof.
+//   make bench && ./bench/parse_bench models/*.obj
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../FloatParser.h"
+
+namespace {
+
+struct NumberLines {
+    std::vector<char> text;           // arquivo + '\0' + kParsePadding
+    std::vector<size_t> lineStarts;   // logo depois de "v", "vt" ou "vn"
+    std::vector<int> counts;          // números por linha
+    size_t numbers{0};
+};
+
+NumberLines Load(const char* path) {
+    NumberLines lines;
+    std::ifstream file(path, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    lines.text.assign(content.begin(), content.end());
+    lines.text.resize(content.size() + 1 + kParsePadding, '\0');
+
+    const char* text = lines.text.data();
+    for (size_t i = 0; i < content.size();) {
+        const char* p = text + i;
+        if (p[0] == 'v' && p[1] == ' ') {
+            lines.lineStarts.push_back(i + 1);
+            lines.counts.push_back(3);
+        } else if (p[0] == 'v' && (p[1] == 't' || p[1] == 'n') && p[2] == ' ') {
+            lines.lineStarts.push_back(i + 2);
+            lines.counts.push_back(p[1] == 't' ? 2 : 3);
+        }
+        const char* end = static_cast<const char*>(memchr(p, '\n', content.size() - i));
+        i = end ? static_cast<size_t>(end - text) + 1 : content.size();
+    }
+    for (int count : lines.counts) lines.numbers += count;
+    return lines;
+}
+
+const char* SkipSpaces(const char* p) {
+    while (*p == ' ' || *p == '\t') p++;
+    return p;
+}
+
+// Melhor de 5 execuções, em ms
+double Time(const std::function<void()>& run) {
+    double best = 1e30;
+    for (int i = 0; i < 5; i++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "uso: %s arquivo.obj...\n", argv[0]);
+        return 1;
+    }
+
+    printf("%-28s %9s %12s %12s %12s %9s\n", "arquivo", "números", "iostream ms", "strtof ms", "ParseFloat", "diferem");
+    for (int arg = 1; arg < argc; arg++) {
+        NumberLines lines = Load(argv[arg]);
+        std::vector<float> reference(lines.numbers), parsed(lines.numbers), streamed(lines.numbers);
+        const char* text = lines.text.data();
+
+        double streamMs = Time([&] {
+            size_t out = 0;
+            for (size_t i = 0; i < lines.lineStarts.size(); i++) {
+                const char* start = text + lines.lineStarts[i];
+                std::istringstream iss(std::string(start, strcspn(start, "\n")));
+                for (int k = 0; k < lines.counts[i]; k++) iss >> streamed[out++];
+            }
+        });
+        double strtofMs = Time([&] {
+            size_t out = 0;
+            for (size_t i = 0; i < lines.lineStarts.size(); i++) {
+                const char* p = text + lines.lineStarts[i];
+                for (int k = 0; k < lines.counts[i]; k++) {
+                    char* end;
+                    reference[out++] = strtof(p, &end);
+                    p = end;
+                }
+            }
+        });
+        double parseMs = Time([&] {
+            size_t out = 0;
+            for (size_t i = 0; i < lines.lineStarts.size(); i++) {
+                const char* p = text + lines.lineStarts[i];
+                for (int k = 0; k < lines.counts[i]; k++) p = ParseFloat(SkipSpaces(p), parsed[out++]);
+            }
+        });
+
+        size_t mismatches = 0;
+        for (size_t i = 0; i < lines.numbers; i++) {
+            if (memcmp(&reference[i], &parsed[i], sizeof(float)) != 0) mismatches++;
+        }
+        const char* name = strrchr(argv[arg], '/') ? strrchr(argv[arg], '/') + 1 : argv[arg];
+        printf("%-28s %9zu %12.2f %12.2f %12.2f %9zu\n", name, lines.numbers, streamMs, strtofMs, parseMs, mismatches);
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+#version 330 core
+// Passe de tela cheia do deferred: luz direcional + ambiente e pixels emissivos.
+// Mesma conta de CalcDirLight em fs.glsl, lendo o material do G-buffer (shadow.glsl é inserido).
+out vec4 FragColor;
+
+in vec2 ndc;
+
+struct DirLight {
+    vec3 direction;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+uniform sampler2D gAlbedo;
+uniform sampler2D gNormal;
+uniform sampler2D gDiffuse;
+uniform sampler2D gSpecular;
+uniform sampler2D gDepth;
+
+uniform mat4 invViewProjection;
+uniform vec3 viewPos;
+uniform DirLight dirLight;
+
+void main()
+{
+    vec2 uv = ndc * 0.5 + 0.5;
+    float depth = texture(gDepth, uv).r;
+    if (depth == 1.0)
+        discard;  // fundo: fica para o céu
+
+    vec4 albedo = texture(gAlbedo, uv);
+    if (albedo.a > 0.5) {
+        FragColor = vec4(albedo.rgb, 1.0);
+        return;
+    }
+
+    vec4 world = invViewProjection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+    vec3 fragPos = world.xyz / world.w;
+    vec4 normalShininess = texture(gNormal, uv);
+    vec3 normal = normalize(normalShininess.xyz);
+    vec3 diffuseReflection = texture(gDiffuse, uv).rgb;
+    vec3 specularReflection = texture(gSpecular, uv).rgb;
+
+    vec3 viewDir = normalize(viewPos - fragPos);
+    vec3 lightDir = normalize(-dirLight.direction);
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), normalShininess.w);
+
+    vec3 ambient = dirLight.ambient * albedo.rgb * diffuseReflection;
+    vec3 diffuse = dirLight.diffuse * diff * diffuseReflection;
+    vec3 specular = dirLight.specular * spec * specularReflection;
+    FragColor = vec4(ambient + (diffuse + specular) * SunShadow(fragPos, normal), 1.0);
+}
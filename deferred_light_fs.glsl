@@ -0,0 +1,67 @@
+#version 330 core
+// Uma point/spot light acumulada (blend aditivo) nos pixels cobertos pelo seu volume.
+// Mesma conta de CalcPointLight/CalcSpotLight em fs.glsl, lendo o material do G-buffer (shadow.glsl é inserido).
+out vec4 FragColor;
+
+uniform sampler2D gAlbedo;
+uniform sampler2D gNormal;
+uniform sampler2D gDiffuse;
+uniform sampler2D gSpecular;
+uniform sampler2D gDepth;
+
+uniform mat4 invViewProjection;
+uniform vec2 screenSize;
+uniform vec3 viewPos;
+
+uniform bool isSpot;
+uniform vec3 lightPosition;
+uniform vec3 lightDirection;
+uniform vec3 lightColor;
+uniform float cutOff;
+uniform float outerCutOff;
+uniform int shadowLayer;
+uniform float constant;
+uniform float linear;
+uniform float quadratic;
+uniform vec3 lightAmbient;
+uniform vec3 lightDiffuse;
+uniform vec3 lightSpecular;
+
+void main()
+{
+    vec2 uv = gl_FragCoord.xy / screenSize;
+    float depth = texture(gDepth, uv).r;
+    vec4 albedo = texture(gAlbedo, uv);
+    if (depth == 1.0 || albedo.a > 0.5)
+        discard;
+
+    vec4 world = invViewProjection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+    vec3 fragPos = world.xyz / world.w;
+    vec4 normalShininess = texture(gNormal, uv);
+    vec3 normal = normalize(normalShininess.xyz);
+    vec3 diffuseReflection = texture(gDiffuse, uv).rgb;
+    vec3 specularReflection = texture(gSpecular, uv).rgb;
+
+    vec3 viewDir = normalize(viewPos - fragPos);
+    vec3 lightDir = normalize(lightPosition - fragPos);
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), normalShininess.w);
+
+    float distance = length(lightPosition - fragPos);
+    float attenuation = 1.0 / (constant + linear * distance + quadratic * (distance * distance));
+
+    float intensity = 1.0;
+    if (isSpot) {
+        float theta = dot(lightDir, normalize(-lightDirection));
+        float epsilon = cutOff - outerCutOff;
+        intensity = clamp((theta - outerCutOff) / epsilon, 0.0, 1.0);
+    }
+    float shadow = isSpot ? SpotShadow(shadowLayer, fragPos, normal) : 1.0;
+
+    vec3 ambient = lightAmbient * albedo.rgb * diffuseReflection;
+    vec3 diffuse = lightDiffuse * diff * diffuseReflection * shadow;
+    vec3 specular = lightSpecular * spec * specularReflection * shadow;
+
+    FragColor = vec4((ambient + diffuse + specular) * lightColor * attenuation * intensity, 1.0);
+}
@@ -0,0 +1,11 @@
+#version 330 core
+// Volume de luz: esfera unitária escalada para o raio de alcance da luz
+layout (location = 0) in vec3 position;
+
+uniform mat4 viewProjection;
+uniform vec3 lightCenter;
+uniform float lightRadius;
+
+void main() {
+    gl_Position = viewProjection * vec4(position * lightRadius + lightCenter, 1.0);
+}
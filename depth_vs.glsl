@@ -0,0 +1,17 @@
+#version 330 core
+// Depth pre-pass: só posição. A conta de gl_Position é a mesma de vs.glsl (e ambos são invariant)
+// para que o passe de shading com GL_EQUAL encontre exatamente a mesma profundidade.
+layout (location = 0) in vec3 position;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 positionOffset;  // Mesh::BindDecode, como em vs.glsl
+uniform vec3 positionScale;
+
+invariant gl_Position;
+
+void main() {
+    vec3 FragPos = vec3(model * vec4(positionOffset + positionScale * position, 1.0));
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -1,22 +1,26 @@
 #version 330 core
+// Variantes compiladas por ShaderVariants, com #defines inseridos depois do #version:
+//   EMISSIVE             fonte de luz: só textura * emissão, sem iluminação
+//   NO_SPECULAR          material sem reflexão especular
+//   NO_SHADOWS           sem amostrar os shadow maps (shadow.glsl)
+//   NUM_POINT_LIGHTS N   quantidade exata de luzes, laços com limite constante
+//   NUM_SPOT_LIGHTS N
+//   INSTANCE_TINT        cor por instância vinda do vertex shader (grama, grass_vs.glsl)
 out vec4 FragColor;
 
+#ifndef NUM_POINT_LIGHTS
+#define NUM_POINT_LIGHTS 0
+#endif
+#ifndef NUM_SPOT_LIGHTS
+#define NUM_SPOT_LIGHTS 0
+#endif
+
 struct Material {
     sampler2D diffuse;
     vec3 emission;    
     vec3 diffuseReflection;
     vec3 specularReflection;
     float shininess;
-    bool isLightSource;
-    bool isActive;
-    
-    float constant;
-    float linear;
-    float quadratic;
-
-    float cutOff;
-    float outerCutOff;
-    vec3 direction;
 }; 
 
 struct DirLight {
@@ -54,58 +58,79 @@ struct SpotLight {
     vec3 ambient;
     vec3 diffuse;
     vec3 specular;
+
+    int shadowLayer;  // -1: sem shadow map
 };
 
-#define MAX_LIGHTS 10
-uniform int numLights;
-uniform int numSpotLights;
-uniform PointLight pointLights[MAX_LIGHTS];
-uniform SpotLight spotLights[MAX_LIGHTS];
+#if NUM_POINT_LIGHTS > 0
+uniform PointLight pointLights[NUM_POINT_LIGHTS];
+#endif
+#if NUM_SPOT_LIGHTS > 0
+uniform SpotLight spotLights[NUM_SPOT_LIGHTS];
+#endif
 uniform DirLight dirLight;
 
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
+#ifdef INSTANCE_TINT
+in vec3 Tint;
+#endif
 
 uniform vec3 viewPos;
 uniform Material material;
 
 
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir, vec3 texColor);
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 texColor);
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 texColor);
+
+// Termo especular de Phong já multiplicado pela reflexão do material
+vec3 Specular(vec3 lightSpecular, vec3 lightDir, vec3 normal, vec3 viewDir)
+{
+#ifdef NO_SPECULAR
+    return vec3(0.0);
+#else
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    return lightSpecular * spec * material.specularReflection;
+#endif
+}
 
 void main()
 {
-    if (material.isLightSource) {
-        vec3 texColor = vec3(texture(material.diffuse, TexCoords));
-        if (material.isActive) {
-            FragColor = vec4(texColor * material.emission, 1.0);
-        }
-        else {
-            FragColor = vec4(texColor * 0.1, 1.0);
-        }
-        return;
-    }
+    // única leitura de textura do fragmento
+    vec3 texColor = vec3(texture(material.diffuse, TexCoords));
+#ifdef INSTANCE_TINT
+    texColor *= Tint;
+#endif
 
+#ifdef EMISSIVE
+    FragColor = vec4(texColor * material.emission, 1.0);
+#else
     vec3 norm = normalize(Normal);
     vec3 viewDir = normalize(viewPos - FragPos);
 
-    vec3 result = CalcDirLight(dirLight, norm, viewDir);
+    vec3 result = CalcDirLight(dirLight, norm, viewDir, texColor);
 
-    for(int i = 0; i < numLights; i++) {
-        result += CalcPointLight(pointLights[i], norm, FragPos, viewDir);
+#if NUM_POINT_LIGHTS > 0
+    for(int i = 0; i < NUM_POINT_LIGHTS; i++) {
+        result += CalcPointLight(pointLights[i], norm, FragPos, viewDir, texColor);
     }
+#endif
 
-    for(int i = 0; i < numSpotLights; i++) {
-        result += CalcSpotLight(spotLights[i], norm, FragPos, viewDir);
+#if NUM_SPOT_LIGHTS > 0
+    for(int i = 0; i < NUM_SPOT_LIGHTS; i++) {
+        result += CalcSpotLight(spotLights[i], norm, FragPos, viewDir, texColor);
     }
+#endif
 
     FragColor = vec4(result, 1.0);
+#endif
 }
 
 
-vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir, vec3 texColor)
 {
     vec3 lightDir = normalize(-light.direction);
 
@@ -113,20 +138,16 @@ vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
     float diff = max(dot(normal, lightDir), 0.0);
 
     
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-
-    
-    vec3 texColor = vec3(texture(material.diffuse, TexCoords));
     vec3 ambient = light.ambient * texColor * material.diffuseReflection;
     vec3 diffuse = light.diffuse * diff * material.diffuseReflection;
-    vec3 specular = light.specular * spec * material.specularReflection;
+    vec3 specular = Specular(light.specular, lightDir, normal, viewDir);
 
-    return (ambient + diffuse + specular);
+    float shadow = SunShadow(FragPos, normal);
+    return (ambient + (diffuse + specular) * shadow);
 }
 
 
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 texColor)
 {
     vec3 lightDir = normalize(light.position - fragPos);
 
@@ -134,35 +155,26 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     float diff = max(dot(normal, lightDir), 0.0);
 
     
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-
-    
     float distance = length(light.position - fragPos);
     float attenuation = 1.0 / (light.constant + light.linear * distance + 
             light.quadratic * (distance * distance));
 
     
-    vec3 texColor = vec3(texture(material.diffuse, TexCoords));
     vec3 ambient = light.ambient * texColor * material.diffuseReflection;
     vec3 diffuse = light.diffuse * diff * material.diffuseReflection;
-    vec3 specular = light.specular * spec * material.specularReflection;
+    vec3 specular = Specular(light.specular, lightDir, normal, viewDir);
 
     
     vec3 colored = (ambient + diffuse + specular) * light.color;
     return colored * attenuation;
 }
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 texColor) {
     vec3 lightDir = normalize(light.position - fragPos);
 
     
     float diff = max(dot(normal, lightDir), 0.0);
 
     
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-
-    
     float distance = length(light.position - fragPos);
     float attenuation = 1.0 / (light.constant + light.linear * distance + 
             light.quadratic * (distance * distance));
@@ -173,14 +185,14 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
     float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
 
     
-    vec3 texColor = vec3(texture(material.diffuse, TexCoords));
     vec3 ambient = light.ambient * texColor * material.diffuseReflection;
     vec3 diffuse = light.diffuse * diff * material.diffuseReflection;
-    vec3 specular = light.specular * spec * material.specularReflection;
+    vec3 specular = Specular(light.specular, lightDir, normal, viewDir);
 
+    float shadow = SpotShadow(light.shadowLayer, fragPos, normal);
     ambient *= attenuation * intensity;
-    diffuse *= attenuation * intensity;
-    specular *= attenuation * intensity;
+    diffuse *= attenuation * intensity * shadow;
+    specular *= attenuation * intensity * shadow;
 
     return (ambient + diffuse + specular) * light.color;
 }
@@ -0,0 +1,10 @@
+#version 330 core
+// Triângulo que cobre a tela inteira, gerado a partir de gl_VertexID (sem vertex buffer).
+// Usado pelo céu e pelos passes de tela cheia do deferred.
+out vec2 ndc;
+
+void main() {
+    ndc = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+    // z = w: profundidade 1.0, o céu só aparece onde nenhuma geometria foi desenhada
+    gl_Position = vec4(ndc, 1.0, 1.0);
+}
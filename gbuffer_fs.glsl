@@ -0,0 +1,45 @@
+#version 330 core
+// Passe de geometria do deferred: grava os dados de material em vez de iluminar
+layout (location = 0) out vec4 gAlbedo;    // rgb: cor da textura (cor final se emissivo), a: 1 = sem iluminação
+layout (location = 1) out vec4 gNormal;    // xyz: normal no mundo, w: shininess
+layout (location = 2) out vec4 gDiffuse;   // rgb: diffuseReflection
+layout (location = 3) out vec4 gSpecular;  // rgb: specularReflection
+
+struct Material {
+    sampler2D diffuse;
+    vec3 emission;
+    vec3 diffuseReflection;
+    vec3 specularReflection;
+    float shininess;
+    bool isLightSource;
+};
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+#ifdef INSTANCE_TINT
+in vec3 Tint;  // grass_vs.glsl
+#endif
+
+uniform Material material;
+
+void main()
+{
+    vec3 texColor = vec3(texture(material.diffuse, TexCoords));
+#ifdef INSTANCE_TINT
+    texColor *= Tint;
+#endif
+
+    if (material.isLightSource) {
+        gAlbedo = vec4(texColor * material.emission, 1.0);  // Object já troca a emissão de luz apagada
+        gNormal = vec4(0.0);
+        gDiffuse = vec4(0.0);
+        gSpecular = vec4(0.0);
+        return;
+    }
+
+    gAlbedo = vec4(texColor, 0.0);
+    gNormal = vec4(normalize(Normal), material.shininess);
+    gDiffuse = vec4(material.diffuseReflection, 0.0);
+    gSpecular = vec4(material.specularReflection, 0.0);
+}
@@ -0,0 +1,28 @@
+#version 330 core
+// Tufos de grama instanciados (GrassField). Saídas iguais às de vs.glsl, então o mesmo fs.glsl
+// (ou gbuffer_fs.glsl) sombreia a grama, compilado com INSTANCE_TINT
+layout (location = 0) in vec3 position;              // tufo em pé, base em y = 0
+layout (location = 1) in vec2 texture_coord;
+layout (location = 3) in vec4 instancePositionAngle;  // xyz: base no mundo, w: giro em Y
+layout (location = 4) in vec4 instanceScaleTint;      // x: escala, yzw: cor
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+out vec3 Tint;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main() {
+    float c = cos(instancePositionAngle.w);
+    float s = sin(instancePositionAngle.w);
+    vec3 local = position * instanceScaleTint.x;
+    FragPos = instancePositionAngle.xyz + vec3(c * local.x + s * local.z, local.y, -s * local.x + c * local.z);
+    // normal do chão: a grama acompanha a iluminação do terreno embaixo dela
+    Normal = vec3(0.0, 1.0, 0.0);
+    TexCoords = texture_coord;
+    Tint = instanceScaleTint.yzw;
+
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
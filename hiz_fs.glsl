@@ -0,0 +1,20 @@
+#version 330 core
+// Um nível da pirâmide Hi-Z: cada texel guarda a maior profundidade do bloco do nível anterior.
+// Lê 3x3 texels (a partir de 2x) em vez de 2x2: cobre a coluna/linha que sobra em tamanhos
+// ímpares, e um bloco maior só deixa o teste mais conservador
+out float maxDepth;
+
+uniform sampler2D source;  // profundidade copiada (nível 0) ou o nível anterior
+uniform ivec2 sourceSize;
+
+void main() {
+    ivec2 base = ivec2(gl_FragCoord.xy) * 2;
+    float depth = 0.0;
+    for (int y = 0; y < 3; y++) {
+        for (int x = 0; x < 3; x++) {
+            ivec2 texel = min(base + ivec2(x, y), sourceSize - 1);
+            depth = max(depth, texelFetch(source, texel, 0).r);
+        }
+    }
+    maxDepth = depth;
+}
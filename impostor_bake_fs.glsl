@@ -0,0 +1,37 @@
+#version 330 core
+// Bake dos impostores (com vs.glsl, modelo em coordenadas do objeto): uma camada do atlas por saída.
+// Fora do objeto tudo fica 0, então cada camada sai multiplicada pela cobertura (alpha da camada 0)
+layout (location = 0) out vec4 bakeAlbedo;   // rgb: textura * diffuseReflection (cor final se emissivo), a: cobertura
+layout (location = 1) out vec4 bakeNormal;   // xyz: normal do objeto em [0, 1], a: 1 = iluminado, 0 = emissivo
+layout (location = 2) out vec4 bakeDiffuse;  // rgb: diffuseReflection (termo difuso de CalcDirLight)
+
+struct Material {
+    sampler2D diffuse;
+    vec3 emission;
+    vec3 diffuseReflection;
+    vec3 specularReflection;
+    float shininess;
+    bool isLightSource;
+};
+
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoords;
+
+uniform Material material;
+
+void main()
+{
+    vec3 texColor = vec3(texture(material.diffuse, TexCoords));
+
+    if (material.isLightSource) {
+        bakeAlbedo = vec4(texColor * material.emission, 1.0);
+        bakeNormal = vec4(0.5, 0.5, 0.5, 0.0);
+        bakeDiffuse = vec4(0.0, 0.0, 0.0, 1.0);
+        return;
+    }
+
+    bakeAlbedo = vec4(texColor * material.diffuseReflection, 1.0);
+    bakeNormal = vec4(normalize(Normal) * 0.5 + 0.5, 1.0);
+    bakeDiffuse = vec4(material.diffuseReflection, 1.0);
+}
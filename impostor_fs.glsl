@@ -0,0 +1,48 @@
+#version 330 core
+// Ilumina o impostor só com a luz direcional, nos mesmos termos de CalcDirLight em fs.glsl
+// (sem especular nem sombra: o objeto está longe). Camadas do atlas em impostor_bake_fs.glsl
+out vec4 FragColor;
+
+struct DirLight {
+    vec3 direction;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+in vec3 FragPos;
+in vec2 TileCoords0;
+in vec2 TileCoords1;
+in float ViewBlend;
+flat in float Yaw;
+
+uniform sampler2DArray atlas;
+uniform DirLight dirLight;
+
+vec4 Sample(float layer) {
+    return mix(texture(atlas, vec3(TileCoords0, layer)), texture(atlas, vec3(TileCoords1, layer)), ViewBlend);
+}
+
+void main()
+{
+    vec4 albedo = Sample(0.0);
+    if (albedo.a < 0.5)
+        discard;
+
+    // as camadas vêm multiplicadas pela cobertura (fundo 0 no bake e nos mipmaps)
+    vec4 normalLit = Sample(1.0) / albedo.a;
+    vec3 color = albedo.rgb / albedo.a;
+    if (normalLit.a < 0.5) {
+        FragColor = vec4(color, 1.0);
+        return;
+    }
+
+    vec3 n = normalize(normalLit.xyz * 2.0 - 1.0);
+    float c = cos(Yaw);
+    float s = sin(Yaw);
+    n = vec3(c * n.x + s * n.z, n.y, -s * n.x + c * n.z);
+
+    vec3 diffuseReflection = Sample(2.0).rgb / albedo.a;
+    float diff = max(dot(n, normalize(-dirLight.direction)), 0.0);
+    FragColor = vec4(dirLight.ambient * color + dirLight.diffuse * diff * diffuseReflection, 1.0);
+}
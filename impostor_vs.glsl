@@ -0,0 +1,48 @@
+#version 330 core
+// Impostor: um quad em pé virado para a câmera (gira só em Y) no lugar do objeto distante.
+// A vista i do atlas foi feita da direção (sin a, 0, cos a), a = i * 2pi / VIEWS, no espaço do
+// objeto; o quad mistura as duas vistas mais próximas da direção da câmera.
+// VIEWS e COLUMNS batem com Impostors::kViews/kColumns.
+layout (location = 0) in vec2 corner;        // [-1, 1]²
+layout (location = 1) in vec4 centerRadius;  // por instância: centro da esfera no mundo e raio
+layout (location = 2) in float yaw;          // por instância: rotação do objeto em Y
+
+const int VIEWS = 16;
+const int COLUMNS = 4;
+const int ROWS = VIEWS / COLUMNS;
+const float PI = 3.14159265359;
+
+out vec3 FragPos;
+out vec2 TileCoords0;
+out vec2 TileCoords1;
+out float ViewBlend;
+flat out float Yaw;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 viewPos;
+
+vec2 TileCoords(int index, vec2 uv) {
+    return (vec2(index % COLUMNS, index / COLUMNS) + uv) / vec2(COLUMNS, ROWS);
+}
+
+void main() {
+    vec3 toCamera = viewPos - centerRadius.xyz;
+    toCamera.y = 0.0;
+    toCamera = dot(toCamera, toCamera) > 1e-6 ? normalize(toCamera) : vec3(0.0, 0.0, 1.0);
+    // mesmo eixo x do lookAt usado no bake
+    vec3 right = cross(-toCamera, vec3(0.0, 1.0, 0.0));
+
+    FragPos = centerRadius.xyz + (right * corner.x + vec3(0.0, corner.y, 0.0)) * centerRadius.w;
+
+    float azimuth = atan(toCamera.x, toCamera.z) - yaw;
+    float index = mod(azimuth / (2.0 * PI) * float(VIEWS), float(VIEWS));
+    int first = int(index) % VIEWS;
+    vec2 uv = corner * 0.5 + 0.5;
+    TileCoords0 = TileCoords(first, uv);
+    TileCoords1 = TileCoords((first + 1) % VIEWS, uv);
+    ViewBlend = fract(index);
+    Yaw = yaw;
+
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -2,61 +2,78 @@
 #include <GLFW/glfw3.h>
 #include <glm/fwd.hpp>
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <iomanip>
+#include <atomic>
 #include <vector>
+#include <cstdlib>
+#include <thread>
+#include <future>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <sys/resource.h>
+#include <sys/stat.h>
 #include "Object.h"
 #include "Camera.h"
-
-std::string loadShaderFromFile(const char* filePath) {
-    std::string shaderCode;
-    std::ifstream shaderFile;
-
-    shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-
-    try {
-
-        shaderFile.open(filePath);
-        std::stringstream shaderStream;
-
-        shaderStream << shaderFile.rdbuf();
-
-        shaderFile.close();
-
-        shaderCode = shaderStream.str();
-    }
-    catch (std::ifstream::failure& e) {
-        std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
-    }
-
-    return shaderCode;
-}
+#include "Tracer.h"
+#include "FrameTimer.h"
+#include "FrameSnapshot.h"
+#include "Scene.h"
+#include "TextureCache.h"
+#include "Shader.h"
+#include "SkyPass.h"
+#include "RenderStats.h"
+#include "DeferredRenderer.h"
+#include "ShadowMaps.h"
+#include "ShaderVariants.h"
+#include "HotReload.h"
+#include "Impostors.h"
+#include "HiZOcclusion.h"
+#include "SoftwareOcclusion.h"
+#include "GrassField.h"
 
 std::string vertexShader;
 std::string fragmentShader;
 bool polygonal_mode = false;
-glm::vec3 eyeLeft(0.75865, 8.79846, 1.0f);
-glm::vec3 eyeCentroid(0.03f, 8.79846, 1.0f);
-glm::vec3 eyeDirection(0.0f);
-glm::vec3 flashlightCentroid(-0.0432864, -0.05f, -0.274723);
-glm::vec3 flashlightFront(-0.0432864, -0.05f, -0.574723);
+
+struct RendererOptions {
+    FrameTimingConfig timing;
+    bool renderThread{true};  // false: simulação e renderização na mesma thread
+    std::string scenePath{"scenes/default.scene"};
+    bool depthPrepass{true};
+    bool deferred{false};     // G-buffer + volumes de luz em vez do forward em fs.glsl
+    bool shadows{true};
+    bool lod{true};           // níveis de detalhe pelo tamanho na tela
+    bool impostors{true};     // quads com vistas pré-renderizadas para objetos distantes
+    bool occlusion{true};     // descarta objetos escondidos pela profundidade do frame anterior
+    bool softwareOcclusion{false};  // em vez do Hi-Z, rasteriza os oclusores da cena na CPU
+    bool packedVertices{true};  // PackedVertex na GPU (16 bytes) em vez de Vertex (32)
+    CpuResidency cpuVertices{CpuResidency::None};  // o que sobra na RAM depois do upload
+    bool streamMeshes{false};  // .obj lidos em segundo plano e enviados aos poucos, já com a cena rodando
+    size_t textureBudgetMB{0};  // > 0: texturas em streaming de mips dentro desse orçamento de VRAM
+    bool grass{true};         // tufos instanciados descritos na linha "grass" da cena
+    bool shaderCache{true};   // binários de programa em shader_cache/
+    bool meshCache{true};     // resultado do LoadOBJ em mesh_cache/
+    bool hotReload{true};     // recarrega shaders e texturas alterados em disco
+    bool stats{false};        // imprime contadores do render a cada segundo
+};
+
+// Streaming: bytes enviados por mesh a cada frame (vértices + stream de posições), ~170 mil vértices compactos
+const size_t kStreamBytesPerFrame = 4 << 20;
 
 class Renderer {
     public:
         static Renderer* instance;
-        Renderer(int width, int height)
-            : width(width), height(height), camera(nullptr)
+        Renderer(int width, int height, const RendererOptions& options)
+            : width(width), height(height), options(options), camera(nullptr), frameTimer(options.timing)
         {
             instance = this;
             InitializeGLFW();
             InitializeOpenGL();
             InitializeShaders();
-            LoadObjects();
-            lightPos = glm::vec3(0.0f, 150.0f, 0.0f);
-            dirLight.ambient = glm::vec3(0.2f);
-            dirLight.diffuse = glm::vec3(0.02f);     
-            dirLight.specular = glm::vec3(0.2f);   
-            dirLight.direction = glm::normalize(glm::vec3(0.0f) - lightPos);
+            stats.SetEnabled(options.stats);
+            LoadObjects(options.scenePath.c_str());
+            WarmUpShaders();
         }
 
         ~Renderer() {
@@ -67,13 +84,45 @@ class Renderer {
             camera = new Camera(width, height, 70.0f, 4.0f, 0.0f);
             glfwSetCursorPos(window, width/2, height/2);
 
+            // O contexto GL passa para a thread de render; esta thread fica com input e simulação
+            std::thread renderThread;
+            if (options.renderThread) {
+                glfwMakeContextCurrent(NULL);
+                renderThread = std::thread(&Renderer::RenderThreadMain, this);
+            } else {
+                frameTimer.ApplySwapInterval();
+            }
+
+            frameTimer.Reset();
             while (!glfwWindowShouldClose(window)) {
-                RenderFrame();
-                camera->ProcessKeyboard(window);
+                glfwPollEvents();
+
+                float deltaTime = frameTimer.BeginFrame();
+                if (frameTimer.UsesFixedStep()) {
+                    for (int steps = frameTimer.ConsumeFixedSteps(); steps > 0; steps--)
+                        Update(frameTimer.FixedStep());
+                } else {
+                    Update(deltaTime);
+                }
+
+                if (options.renderThread) {
+                    BuildSnapshot(snapshots.WriteSlot());
+                    snapshots.Publish();
+                } else {
+                    BuildSnapshot(immediateSnapshot);
+                    RenderFrame(immediateSnapshot);
+                }
+                frameTimer.LimitFrameRate();
 
                 if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
                     glfwSetWindowShouldClose(window, GL_TRUE);
             }
+
+            if (options.renderThread) {
+                snapshots.Close();
+                renderThread.join();
+                glfwMakeContextCurrent(window);
+            }
         }
 
         void HandleKeyInput(GLFWwindow* window, int key, int scancode, int action, int mods) {
@@ -86,6 +135,34 @@ class Renderer {
                         std::cout << "Selected object " << index << " " << objects[selectedObjectIndex]->name << std::endl;
                     }
                 }
+                if (key == GLFW_KEY_F2 && action == GLFW_PRESS) {
+                    options.depthPrepass = !options.depthPrepass;
+                    std::cout << "Depth pre-pass " << (options.depthPrepass ? "on" : "off") << std::endl;
+                }
+                if (key == GLFW_KEY_F3 && action == GLFW_PRESS) {
+                    options.deferred = !options.deferred;
+                    std::cout << (options.deferred ? "Deferred" : "Forward") << " shading" << std::endl;
+                }
+                if (key == GLFW_KEY_F4 && action == GLFW_PRESS) {
+                    options.shadows = !options.shadows;
+                    std::cout << "Shadows " << (options.shadows ? "on" : "off") << std::endl;
+                }
+                if (key == GLFW_KEY_F5 && action == GLFW_PRESS) {
+                    options.lod = !options.lod;
+                    std::cout << "LOD " << (options.lod ? "on" : "off") << std::endl;
+                }
+                if (key == GLFW_KEY_F6 && action == GLFW_PRESS) {
+                    options.impostors = !options.impostors;
+                    std::cout << "Impostors " << (options.impostors ? "on" : "off") << std::endl;
+                }
+                if (key == GLFW_KEY_F8 && action == GLFW_PRESS) {
+                    // a thread de render é dona do cache de texturas; imprime no próximo frame
+                    memoryReportRequested = true;
+                }
+                if (key == GLFW_KEY_F7 && action == GLFW_PRESS) {
+                    options.occlusion = !options.occlusion;
+                    std::cout << "Occlusion culling " << (options.occlusion ? "on" : "off") << std::endl;
+                }
                 if (key == GLFW_KEY_P) {
                     polygonal_mode = !polygonal_mode;
                 }
@@ -210,10 +287,36 @@ class Renderer {
 
     private:
         int width, height;
+        int framebufferWidth{0}, framebufferHeight{0};  // pixels do viewport (maior que a janela em HiDPI)
+        RendererOptions options;
         GLFWwindow* window;
-        GLuint shaderProgram;
+        ShaderVariants forwardShaders;
+        std::vector<GLuint> preparedPrograms;  // variantes que já receberam os uniforms deste frame
+        GLuint depthProgram;
         std::vector<Object*> objects;
+        std::map<std::string, std::shared_ptr<Mesh>> meshes;
+        TextureCache textureCache;
+        HotReload hotReload;
+        SkyPass skyPass;
+        DeferredRenderer deferred;
+        ShadowMaps shadows;
+        Impostors impostors;
+        HiZOcclusion occlusion;
+        SoftwareOcclusion softwareOcclusion;  // usado só pela simulação (BuildSnapshot)
+        std::atomic<bool> memoryReportRequested{false};  // F8
+        std::vector<const ObjectDrawState*> drawList;  // objetos com mesh visíveis no frame atual
+        std::vector<std::future<void>> streamLoads;           // LoadOBJ dos meshes em streaming
+        std::vector<std::shared_ptr<Mesh>> streamingMeshes;   // ainda não inteiros na GPU (thread de render)
+        GrassField grass;
+        float skySpin = 0.0f;        // rad/s
+        float skyBrightness = 1.0f;
+        float skyRotation = 0.0f;
+        RenderStats stats;
+        double lastFrameTime = 0.0;
         Camera* camera;
+        FrameTimer frameTimer;
+        SnapshotExchange snapshots;
+        FrameSnapshot immediateSnapshot;
         int selectedObjectIndex = -1;  
         const float rotationSpeed = 0.05f;
         const float translationSpeed = 0.5f;
@@ -221,44 +324,7 @@ class Renderer {
         glm::vec3 lightPos;  
         bool ambientLightEnabled = true;
 
-        // Estruturas de Luz
-        struct DirLight {
-            glm::vec3 direction;
-            glm::vec3 ambient;
-            glm::vec3 diffuse;
-            glm::vec3 specular;
-        } dirLight;
-
-        struct PointLight {
-            glm::vec3 position;
-            glm::vec3 color;
-            float constant;
-            float linear;
-            float quadratic;
-            glm::vec3 ambient;
-            glm::vec3 diffuse;
-            glm::vec3 specular;
-        };
-
-        struct SpotLight {
-            glm::vec3 position;
-            glm::vec3 direction;
-            glm::vec3 color;
-
-            float cutOff;
-            float outerCutOff;
-
-            float constant;
-            float linear;
-            float quadratic;
-
-            glm::vec3 ambient;
-            glm::vec3 diffuse;
-            glm::vec3 specular;
-        };
-
-        std::vector<PointLight> pointLights;
-        std::vector<SpotLight> spotLights;
+        DirLight dirLight;
 
         // Funções auxiliares OpenGL/GLFW
         void InitializeGLFW() {
@@ -298,361 +364,245 @@ class Renderer {
         }
 
         void InitializeShaders() {
-            GLuint vs = CreateShader(GL_VERTEX_SHADER, vertexShader.c_str());
-            GLuint fs = CreateShader(GL_FRAGMENT_SHADER, fragmentShader.c_str());
-
-            shaderProgram = glCreateProgram();
-            glAttachShader(shaderProgram, vs);
-            glAttachShader(shaderProgram, fs);
-            glLinkProgram(shaderProgram);
-
-            GLint success;
-            glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-            if (!success) {
-                char infoLog[512];
-                glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-                throw std::runtime_error("Shader program linking failed: " + std::string(infoLog));
-            }
-
-            glDeleteShader(vs);
-            glDeleteShader(fs);
-            glUseProgram(shaderProgram);
-        }
-
-        GLuint CreateShader(GLenum type, const char* source) {
-            GLuint shader = glCreateShader(type);
-            glShaderSource(shader, 1, &source, NULL);
-            glCompileShader(shader);
-
-            GLint success;
-            glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-            if (!success) {
-                char infoLog[512];
-                glGetShaderInfoLog(shader, 512, NULL, infoLog);
-                throw std::runtime_error("Shader compilation failed: " + std::string(infoLog));
-            }
-
-            return shader;
-        }
-
-        // Define objetos com texturas + propriedades difusas/especulares 
-        void LoadObjects() {
-            std::vector<const char*> skyTextures = {
-                "textures/night.png",
-            };
-            std::vector<MaterialProperties> skyProperties = {
-                MaterialProperties(
-                        glm::vec3(0.0f),     
-                        glm::vec3(0.9f),
-                        glm::vec3(0.1f),
-                        3.0f,                
-                        false            
-                        )
-            };
-
-            std::vector<const char*> treeTextures = {
-                "textures/tree.jpg",
-            };
-            std::vector<MaterialProperties> treeProperties = {
-                MaterialProperties(
-                        glm::vec3(0.0f),     
-                        glm::vec3(0.6f),     
-                        glm::vec3(0.6f),     
-                        1.0f,                
-                        false                
-                        )
-            };
-
-
-            std::vector<const char*> grassTextures = {
-                "textures/grass.jpg",
-            };
-            std::vector<MaterialProperties> grassProperties = {
-                MaterialProperties(
-                        glm::vec3(0.0f),        
-                        glm::vec3(1.0f),        
-                        glm::vec3(1.0f),        
-                        1.0f,                   
-                        false                   
-                        )
-            };
-
-            std::vector<const char*> houseTextures = {
-                "textures/tramy-UVout.png",
-                "textures/House-diff.png"
-            };
-            std::vector<MaterialProperties> houseProperties = {
-                MaterialProperties(
-                        glm::vec3(0.0f),        
-                        glm::vec3(0.7f),        
-                        glm::vec3(0.3f),        
-                        32.0f,                  
-                        false                   
-                        ),
-                MaterialProperties(
-                        glm::vec3(0.0f),        
-                        glm::vec3(0.8f),        
-                        glm::vec3(0.2f),        
-                        16.0f,                  
-                        false                   
-                        )
-            };
-
-
-            std::vector<const char*> lampTextures = {
-                "textures/street_lamp_black.png",
-                "textures/street_lamp_white.png",
-                "textures/street_lamp_grey.png",
-            };
-            std::vector<MaterialProperties> lampProperties = {
-                MaterialProperties(  
-                        glm::vec3(0.0f),        
-                        glm::vec3(0.2f),        
-                        glm::vec3(0.8f),        
-                        32.0f,                  
-                        false                   
-                        ),
-                MaterialProperties(  
-                        glm::vec3(1.0f, 0.9f, 0.7f) * 2.0f,  
-                        glm::vec3(0.8f),        
-                        glm::vec3(0.9f),        
-                        1.0f,                   
-                        true                    
-                        ),
-                MaterialProperties(  
-                        glm::vec3(0.0f),        
-                        glm::vec3(0.5f),        
-                        glm::vec3(0.3f),        
-                        16.0f,                  
-                        false                   
-                        )
-            };
-
-            std::vector<const char*> giantTextures = {
-                "textures/laser_eyes.png",
-                "textures/stone.png",
-                "textures/stone.png",
-                "textures/stone.png"
-            };
-            std::vector<MaterialProperties> giantProperties = {
-                MaterialProperties(  
-                        glm::vec3(0.0f, 1.0f, 0.0f) * 2.0f,  
-                        glm::vec3(0.7f),        
-                        glm::vec3(0.9f),        
-                        1.0f,                   
-                        true,                   
-                        1.0f,                        
-                        0.09f,                       
-                        0.22f,                        
-                        glm::cos(glm::radians(25.f)), 
-                        glm::cos(glm::radians(30.f)), 
-                        glm::vec3(0.0f, 1.0f, 1.0f)   
-                        ),
-                MaterialProperties(  
-                        glm::vec3(0.0f),        
-                        glm::vec3(0.6f),        
-                        glm::vec3(0.2f),        
-                        1.0f,                   
-                        false                   
-                        ),
-                MaterialProperties(  
-                        glm::vec3(0.0f),        
-                        glm::vec3(0.6f),        
-                        glm::vec3(0.2f),        
-                        1.0f,                   
-                        false                   
-                        ),
-                MaterialProperties(  
-                        glm::vec3(0.0f),        
-                        glm::vec3(0.6f),        
-                        glm::vec3(0.2f),        
-                        1.0f,                   
-                        false                   
-                        )
-
-            };
-
-            std::vector<const char*> flashlightTextures = {
-                "textures/red.png",
-                "textures/grey.jpg",
-                "textures/red.png"
-            };
-            std::vector<MaterialProperties> flashlightProperties = {
-                MaterialProperties(  
-                        glm::vec3(0.0f),             
-                        glm::vec3(0.7f),             
-                        glm::vec3(0.3f),             
-                        1.0f,                        
-                        false                        
-                        ),
-                MaterialProperties(  
-                        glm::vec3(0.8f, 0.8f, 0.8f),  
-                        glm::vec3(0.8f),             
-                        glm::vec3(0.9f),             
-                        1.0f,                        
-                        true,                        
-                        1.0f,                        
-                        0.09f,                       
-                        0.001f,                        
-                        glm::cos(glm::radians(25.f)), 
-                        glm::cos(glm::radians(30.f)), 
-                        glm::vec3(0.0f, 1.0f, 1.0f)   
-                        ),
-                MaterialProperties(  
-                        glm::vec3(0.0f),             
-                        glm::vec3(0.7f),             
-                        glm::vec3(0.3f),             
-                        1.0f,                        
-                        false                        
-                        )
-            };
-
-            std::vector<const char*> smallLampTextures = {
-                "textures/brown.png",
-                "textures/orange.jpg"
-            };
-            std::vector<MaterialProperties> smallLampProperties = {
-                MaterialProperties(  
-                        glm::vec3(0.0f),             
-                        glm::vec3(0.6f),             
-                        glm::vec3(0.4f),             
-                        32.0f,                       
-                        false                        
-                        ),
-                MaterialProperties(  
-                        glm::vec3(1.0f, 0.5f, 0.0f),  
-                        glm::vec3(0.8f),              
-                        glm::vec3(0.9f),              
-                        1.0f,                         
-                        true,                         
-                        0.0f,                         
-                        0.1f,                         
-                        0.22f                         
-                        )
-            };
-
-            std::vector<const char*> thinkerTextures = {
-                "textures/grey.jpg",
-                "textures/grey.jpg"
-            };
-
-            std::vector<MaterialProperties> thinkerProperties = {
-                MaterialProperties(
-                        glm::vec3(0.02f),       
-                        glm::vec3(0.5f),        
-                        glm::vec3(0.7f),        
-                        256.0f,                 
-                        false
-                        ),
-                MaterialProperties(
-                        glm::vec3(0.02f),       
-                        glm::vec3(0.5f),        
-                        glm::vec3(0.7f),        
-                        256.0f,                 
-                        false
-                        )
-            };
-
-            std::vector<const char*> victoryTextures = {
-                "textures/grey.jpg",
-            };
-
-            std::vector<MaterialProperties> victoryProperties = {
-                MaterialProperties(
-                        glm::vec3(0.02f),       
-                        glm::vec3(0.3f),        
-                        glm::vec3(0.8f),        
-                        256.0f,                 
-                        false
-                        )
-            };
-
-            std::vector<const char*> nightstandTextures = {
-                "textures/stand.png",
-            };
-            std::vector<MaterialProperties> nightstandProperties = {
-                MaterialProperties(
-                        glm::vec3(0.02f),       
-                        glm::vec3(0.7f),        
-                        glm::vec3(0.2f),        
-                        32.0f,                  
-                        false
-                        )
-            };
-
-            std::vector<const char*> bedTextures = {
-                "textures/bed.png",
-                "textures/bed_sheet.png",
-                "textures/pillows.png"
-            };
-            std::vector<MaterialProperties> bedProperties = {
-                MaterialProperties(
-                        glm::vec3(0.0f),       
-                        glm::vec3(0.95f),        
-                        glm::vec3(0.1f),        
-                        2.0f,                   
-                        false
-                        ),
-                MaterialProperties(
-                        glm::vec3(0.0f),       
-                        glm::vec3(0.95f),        
-                        glm::vec3(0.1f),        
-                        2.0f,                   
-                        false
-                        ),
-                MaterialProperties(
-                        glm::vec3(0.0f),       
-                        glm::vec3(0.95f),        
-                        glm::vec3(0.1f),        
-                        2.0f,                   
-                        false
-                        )
-            };
-            objects.push_back(new Object(shaderProgram, "models/flashlight.obj", flashlightTextures,
-                        flashlightProperties, -9.7f, 3.67f, 14.5f, 1.0f, 4.6f, 1));
-            objects.push_back(new Object(shaderProgram, "models/small_lamp.obj", smallLampTextures,
-                        smallLampProperties, 1.5f, 0.5f, -21.0f, 1.0f, 0.0f, 1));
-            objects.push_back(new Object(shaderProgram, "models/giant.obj", giantTextures,
-                        giantProperties, 80.0f, 0.0f, -20.0f, 1.0f, 0.0f, 1));
-            objects.push_back(new Object(shaderProgram, "models/lamp.obj", lampTextures,
-                        lampProperties, 70.0f, 0.0f, -10.0f, 5.0f, 0.0f, 1));
-            objects.push_back(new Object(shaderProgram, "models/lamp.obj", lampTextures,
-                        lampProperties, 70.0f, 0.0f, 10.0f, 5.0f, 0.0f, 1));
-            objects.push_back(new Object(shaderProgram, "models/casa.obj", houseTextures,
-                        houseProperties, 2.0f, 0.5f, -1.0f, 5.0f, 0.0f, 1));
-            objects.push_back(new Object(shaderProgram, "models/bed.obj", bedTextures,
-                        bedProperties, -6.0f, 0.3f, -18.0f, 2.0f, 0.0f, 1));
-            objects.push_back(new Object(shaderProgram, "models/victory.obj", victoryTextures,
-                        victoryProperties, 13.0f, -0.75f, 14.0f, 0.5f, 3.7f, 1));
-            objects.push_back(new Object(shaderProgram, "models/thinker.obj", thinkerTextures,
-                        thinkerProperties, 4.5f, 0.6f, -21.0f, 0.7f, 9.4f, 1));
-            objects.push_back(new Object(shaderProgram, "models/tree.obj", treeTextures,
-                        treeProperties, 63.0f, 0.0f, -18.0f, 0.3f, 0.0f, 1));
-            objects.push_back(new Object(shaderProgram, "models/sphere.obj", skyTextures,
-                        skyProperties, 0.0f, 0.0f, 0.0f, 200.0f, 0.0f, 1));
-            objects.push_back(new Object(shaderProgram, "models/grass.obj", grassTextures,
-                        grassProperties, 0.0f, 0.0f, 0.0f, 2.0f, 0.0f, 1));
-            objects.push_back(new Object(shaderProgram, "models/nightstand.obj", nightstandTextures,
-                        nightstandProperties, -10.5f, 1.5f, 13.5f, 0.4f, 0.0f, 1));
-        }
-
-        void SetupLighting() {
-            glm::vec3 targetPos(0.0f, 0.0f, 0.0f);  
-            dirLight.direction = glm::normalize(targetPos - lightPos);
-            dirLight.ambient = ambientLightEnabled ? dirLight.ambient : glm::vec3(0.0f);     
+            if (options.shaderCache)
+                EnableProgramCache("shader_cache");
+            forwardShaders.Initialize(vertexShader, InsertAfterVersion(fragmentShader, loadShaderFromFile("shadow.glsl")));
+
+            skyPass.Initialize(CreateProgram(loadShaderFromFile("fullscreen_vs.glsl"), loadShaderFromFile("sky_fs.glsl")));
+            depthProgram = CreateProgram(loadShaderFromFile("depth_vs.glsl"), loadShaderFromFile("depth_fs.glsl"));
+
+            glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+            deferred.Initialize(framebufferWidth, framebufferHeight);
+            shadows.Initialize();
+            impostors.Initialize();
+            occlusion.Initialize(framebufferWidth, framebufferHeight);
+        }
+
+        // Compila antes do primeiro frame as variantes que a cena usa no estado inicial
+        // (luzes apagadas); variantes de outras contagens de luz ficam para quando aparecerem
+        void WarmUpShaders() {
+            TRACE_SCOPE("WarmUpShaders");
+            for (auto obj : objects) {
+                for (const auto& material : obj->materials) {
+                    forwardShaders.Get(ShaderVariants::KeyFor(material, 0, 0, options.shadows));
+                }
+            }
+
+            ProgramCacheStats cache = GetProgramCacheStats();
+            std::cout << "Shaders ready in " << cache.seconds * 1000.0 << " ms (" << cache.loaded
+                      << " from cache, " << cache.compiled << " compiled)" << std::endl;
+        }
+
+        // Carrega a cena descrita em arquivo: texturas são decodificadas em threads de trabalho
+        // enquanto os .obj são lidos em paralelo (menores primeiro); o envio à GPU fica nesta thread.
+        void LoadObjects(const char* scenePath) {
+            TRACE_SCOPE("LoadObjects");
+            SceneDescription scene = LoadSceneFile(scenePath);
+            ValidateSceneAssets(scene);
+
+            lightPos = scene.sunPosition;
+            dirLight.ambient = scene.sunAmbient;
+            dirLight.diffuse = scene.sunDiffuse;
+            dirLight.specular = scene.sunSpecular;
+            dirLight.direction = glm::normalize(glm::vec3(0.0f) - lightPos);
+
+            skySpin = scene.skySpin;
+            skyBrightness = scene.skyBrightness;
+            if (options.meshCache)
+                Mesh::EnableCache("mesh_cache");
+            if (options.textureBudgetMB > 0)
+                textureCache.EnableStreaming(options.textureBudgetMB << 20);
+            if (!scene.skyTexture.empty())
+                skyPass.SetTexture(textureCache.Get(scene.skyTexture, false));
+
+            std::vector<std::string> texturePaths;
+            if (!scene.skyTexture.empty())
+                texturePaths.push_back(scene.skyTexture);
+            for (const auto& material : scene.materials) {
+                if (!material.second.texture.empty()) {
+                    textureCache.Prefetch(material.second.texture);
+                    texturePaths.push_back(material.second.texture);
+                }
+            }
+            if (options.hotReload)
+                hotReload.Start(texturePaths);
+
+            std::vector<std::string> meshOrder;
+            for (const auto& instance : scene.instances) {
+                if (std::find(meshOrder.begin(), meshOrder.end(), instance.mesh) == meshOrder.end())
+                    meshOrder.push_back(instance.mesh);
+            }
+            std::stable_sort(meshOrder.begin(), meshOrder.end(), [&](const std::string& a, const std::string& b) {
+                return FileSize(scene.meshes[a]) < FileSize(scene.meshes[b]);
+            });
+
+            std::set<std::string> occluderMeshes;
+            for (const auto& instance : scene.instances) {
+                if (instance.occluder && options.softwareOcclusion)
+                    occluderMeshes.insert(instance.mesh);
+            }
+
+            // Streaming: o que precisa do mesh inteiro na carga (impostor, proxy de oclusão,
+            // materiais do .mtl) continua síncrono
+            std::set<std::string> streamed;
+            if (options.streamMeshes) {
+                streamed.insert(meshOrder.begin(), meshOrder.end());
+                for (const auto& instance : scene.instances) {
+                    if (instance.impostorDistance > 0.0f || occluderMeshes.count(instance.mesh) || instance.materials.empty())
+                        streamed.erase(instance.mesh);
+                }
+            }
+            for (const auto& name : streamed) {
+                std::string path = scene.meshes[name];
+                auto mesh = std::make_shared<Mesh>();
+                mesh->BeginStreaming(path);
+                streamLoads.push_back(std::async(std::launch::async, [mesh, path]() {
+                    if (!mesh->LoadOBJ(path.c_str()))
+                        std::cerr << "Failed to load OBJ file: " << path << " (streaming stopped)" << std::endl;
+                }));
+                streamingMeshes.push_back(mesh);
+                meshes[name] = mesh;
+            }
+            meshOrder.erase(std::remove_if(meshOrder.begin(), meshOrder.end(),
+                    [&](const std::string& name) { return streamed.count(name) > 0; }), meshOrder.end());
+
+            std::map<std::string, std::future<std::shared_ptr<Mesh>>> pending;
+            for (const auto& name : meshOrder) {
+                std::string path = scene.meshes[name];
+                bool occluder = occluderMeshes.count(name) > 0;
+                pending[name] = std::async(std::launch::async, [path, occluder]() {
+                    auto mesh = std::make_shared<Mesh>();
+                    if (!mesh->LoadOBJ(path.c_str()))
+                        throw std::runtime_error("Failed to load OBJ file: " + path);
+                    mesh->GenerateLods();
+                    if (occluder)
+                        mesh->GenerateOccluder();
+                    return mesh;
+                });
+            }
+            size_t vertexBytes = 0;
+            for (const auto& name : meshOrder) {
+                std::shared_ptr<Mesh> mesh = pending[name].get();
+                mesh->Upload(options.packedVertices);
+                mesh->ReleaseCpuData(options.cpuVertices);
+                vertexBytes += mesh->GpuBytes();
+                meshes[name] = mesh;
+            }
+            std::cout << "Vertex buffers: " << vertexBytes / 1024 << " KB ("
+                      << (options.packedVertices ? "packed" : "float") << ")" << std::endl;
+            if (!streamingMeshes.empty())
+                std::cout << "Streaming " << streamingMeshes.size() << " meshes" << std::endl;
+
+            for (const auto& instance : scene.instances) {
+                std::vector<GLuint> textures;
+                std::vector<MaterialProperties> properties;
+                for (const auto& materialName : instance.materials) {
+                    const SceneMaterial& material = scene.materials[materialName];
+                    textures.push_back(material.texture.empty() ? textureCache.Fallback()
+                                                                : textureCache.Get(material.texture));
+                    properties.push_back(material.properties);
+                }
+                if (instance.materials.empty()) {
+                    // sem "materials" na cena: um material do .mtl para cada usemtl do .obj
+                    const Mesh& mesh = *meshes[instance.mesh];
+                    for (const auto& group : mesh.materialGroups) {
+                        auto found = mesh.objMaterials.find(group.first);
+                        if (found == mesh.objMaterials.end()) {
+                            std::cerr << mesh.path << ": material '" << group.first
+                                      << "' not found in mtllib (using defaults)" << std::endl;
+                            textures.push_back(textureCache.Fallback());
+                            properties.push_back(MaterialProperties());
+                            continue;
+                        }
+                        const ObjMaterial& material = found->second;
+                        textures.push_back(material.texture.empty() ? textureCache.Fallback()
+                                                                    : textureCache.Get(material.texture));
+                        properties.push_back(MaterialProperties(material.emission, material.diffuse,
+                                material.specular, material.shininess));
+                    }
+                }
+
+                Object* obj = new Object(meshes[instance.mesh], textures, properties,
+                        instance.position.x, instance.position.y, instance.position.z,
+                        instance.scale, instance.angle, instance.axis);
+                obj->spinSpeed = instance.spin;
+                obj->hasLightBeam = instance.hasBeam;
+                obj->lightBeamOrigin = instance.beamOrigin;
+                obj->lightBeamTarget = instance.beamTarget;
+                obj->impostorDistance = instance.impostorDistance;
+                obj->occluder = instance.occluder;
+                objects.push_back(obj);
+            }
+
+            if (options.grass && scene.grass.radius > 0.0f) {
+                const SceneMaterial& material = scene.materials[scene.grass.material];
+                grass.Initialize(scene.grass, material.properties,
+                        material.texture.empty() ? textureCache.Fallback() : textureCache.Get(material.texture));
+            }
+
+            // os impostores assam com as texturas inteiras; depois o streaming devolve a VRAM
+            for (auto obj : objects) {
+                if (obj->impostorDistance > 0.0f) {
+                    for (GLuint texture : obj->GetTextures())
+                        textureCache.LoadFull(texture);
+                }
+            }
+            double bakeStart = glfwGetTime();
+            int baked = impostors.Bake(objects);
+            if (baked > 0)
+                std::cout << "Impostors baked: " << baked << " in " << (glfwGetTime() - bakeStart) * 1000.0 << " ms" << std::endl;
+            struct rusage usage;
+            getrusage(RUSAGE_SELF, &usage);
+            std::cout << "Scene loaded, peak RSS " << usage.ru_maxrss / 1024 << " MB" << std::endl;
+            if (options.stats)
+                PrintMemoryReport();
+        }
+
+        // RAM (cópia do mesh na CPU) e VRAM (buffers de vértice e texturas) de cada objeto.
+        // Meshes e texturas são compartilhados entre instâncias: o total conta cada um uma vez
+        void PrintMemoryReport() {
+            std::set<const Mesh*> countedMeshes;
+            std::set<GLuint> countedTextures;
+            size_t totalRam = 0, totalVertices = 0, totalTextures = 0;
+            std::cout << "Memory (KB)          RAM  VRAM vertices  VRAM textures" << std::endl;
+            for (auto obj : objects) {
+                const Mesh& mesh = obj->GetMesh();
+                std::set<GLuint> textures(obj->GetTextures().begin(), obj->GetTextures().end());
+                size_t textureBytes = 0;
+                for (GLuint texture : textures) {
+                    textureBytes += textureCache.TextureBytes(texture);
+                    if (countedTextures.insert(texture).second)
+                        totalTextures += textureCache.TextureBytes(texture);
+                }
+                if (countedMeshes.insert(&mesh).second) {
+                    totalRam += mesh.CpuBytes();
+                    totalVertices += mesh.GpuBytes();
+                }
+                std::cout << "  " << std::left << std::setw(16) << obj->name.substr(obj->name.find_last_of('/') + 1)
+                          << std::right << std::setw(6) << mesh.CpuBytes() / 1024
+                          << std::setw(15) << mesh.GpuBytes() / 1024
+                          << std::setw(15) << textureBytes / 1024 << std::endl;
+            }
+            std::cout << "  " << std::left << std::setw(16) << "total (shared once)" << std::right
+                      << std::setw(6) << totalRam / 1024 << std::setw(15) << totalVertices / 1024
+                      << std::setw(15) << totalTextures / 1024 << std::endl;
+        }
 
-            GLint lightDirLoc = glGetUniformLocation(shaderProgram, "dirLight.direction");
-            GLint lightAmbientLoc = glGetUniformLocation(shaderProgram, "dirLight.ambient");
-            GLint lightDiffuseLoc = glGetUniformLocation(shaderProgram, "dirLight.diffuse");
-            GLint lightSpecularLoc = glGetUniformLocation(shaderProgram, "dirLight.specular");
+        static long FileSize(const std::string& path) {
+            struct stat info;
+            return stat(path.c_str(), &info) == 0 ? static_cast<long>(info.st_size) : 0;
+        }
 
-            glUniform3fv(lightDirLoc, 1, glm::value_ptr(dirLight.direction));
-            glUniform3fv(lightAmbientLoc, 1, glm::value_ptr(dirLight.ambient));
-            glUniform3fv(lightDiffuseLoc, 1, glm::value_ptr(dirLight.diffuse));
-            glUniform3fv(lightSpecularLoc, 1, glm::value_ptr(dirLight.specular));
+        // Parte de CPU da iluminação: roda na simulação e grava as luzes no snapshot
+        void GatherLights(FrameSnapshot& snapshot) {
+            TRACE_SCOPE("GatherLights");
+            glm::vec3 targetPos(0.0f, 0.0f, 0.0f);  
+            dirLight.direction = glm::normalize(targetPos - lightPos);
+            snapshot.dirLight = dirLight;
+            snapshot.dirLight.ambient = ambientLightEnabled ? dirLight.ambient : glm::vec3(0.0f);     
 
-            pointLights.clear();
-            spotLights.clear();
+            snapshot.pointLights.clear();
+            snapshot.spotLights.clear();
 
             // Pega os atributos dos materiais que são lightsources e salva no seu respectivo tipo
             for (const auto& obj : objects) {
@@ -663,22 +613,15 @@ class Renderer {
                         if (mat.cutOff > -0.9f) { 
                             SpotLight light;
                             glm::mat4 model = obj->GetModelMatrix();
-                            // Define direção do raio de luz da lanterna e do gigante
-                            if (obj->name == "models/giant.obj") {
-                                glm::vec3 eyeCentroidNew = glm::vec3(model * glm::vec4(eyeCentroid, 1.0f));
-                                glm::vec3 eyeLeftNew = glm::vec3(model * glm::vec4(eyeLeft, 1.0f));
-                                light.position = eyeCentroidNew; 
-
-                                glm::vec3 leftVector = eyeLeftNew-eyeCentroidNew;
-                                glm::vec3 upVector(0.0f, 1.0f, 0.0f);
-                                eyeDirection = glm::normalize(glm::cross(leftVector, upVector));
-                                light.direction = eyeDirection;
-                            }
-                            else if (obj->name == "models/flashlight.obj") {
-                                glm::vec3 flashlightCentroidNew = glm::vec3(model * glm::vec4(flashlightCentroid, 1.0f));
-                                glm::vec3 flashlightFrontNew = glm::vec3(model * glm::vec4(flashlightFront, 1.0f));
-                                light.position = flashlightCentroidNew;
-                                light.direction = flashlightFrontNew - flashlightCentroidNew;
+                            // Feixe definido na cena (olhos do gigante, lanterna); sem ele a luz sai da origem
+                            if (obj->hasLightBeam) {
+                                glm::vec3 origin = glm::vec3(model * glm::vec4(obj->lightBeamOrigin, 1.0f));
+                                glm::vec3 target = glm::vec3(model * glm::vec4(obj->lightBeamTarget, 1.0f));
+                                light.position = origin;
+                                light.direction = glm::normalize(target - origin);
+                            } else {
+                                light.position = glm::vec3(model * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+                                light.direction = glm::normalize(glm::vec3(model * glm::vec4(mat.direction, 0.0f)));
                             }
                             light.color = mat.emission;
                             light.cutOff = mat.cutOff;
@@ -689,7 +632,9 @@ class Renderer {
                             light.ambient = glm::vec3(0.05f);
                             light.diffuse = glm::vec3(0.8f);
                             light.specular = glm::vec3(0.8f);
-                            spotLights.push_back(light);
+                            light.owner = obj;
+                            light.material = i;
+                            snapshot.spotLights.push_back(light);
                         } 
                         else {
                             PointLight light;
@@ -702,110 +647,470 @@ class Renderer {
                             light.ambient = glm::vec3(0.05f);
                             light.diffuse = glm::vec3(0.8f);
                             light.specular = glm::vec3(0.5f);
-                            pointLights.push_back(light);
+                            snapshot.pointLights.push_back(light);
                         }
                     }
                 }
             }
+        }
 
-            glUniform1i(glGetUniformLocation(shaderProgram, "numLights"), 
-                    static_cast<GLint>(pointLights.size()));
-            glUniform1i(glGetUniformLocation(shaderProgram, "numSpotLights"), 
-                    static_cast<GLint>(spotLights.size()));
+        // Envia as luzes do snapshot para o shader (thread de render)
+        void SetupLighting(GLuint program, const FrameSnapshot& snapshot) {
+            TRACE_SCOPE("SetupLighting");
+            GLint lightDirLoc = glGetUniformLocation(program, "dirLight.direction");
+            GLint lightAmbientLoc = glGetUniformLocation(program, "dirLight.ambient");
+            GLint lightDiffuseLoc = glGetUniformLocation(program, "dirLight.diffuse");
+            GLint lightSpecularLoc = glGetUniformLocation(program, "dirLight.specular");
 
-            // Carrega PointLights
-            for (size_t i = 0; i < pointLights.size(); i++) {
-                std::string base = "pointLights[" + std::to_string(i) + "].";
+            glUniform3fv(lightDirLoc, 1, glm::value_ptr(snapshot.dirLight.direction));
+            glUniform3fv(lightAmbientLoc, 1, glm::value_ptr(snapshot.dirLight.ambient));
+            glUniform3fv(lightDiffuseLoc, 1, glm::value_ptr(snapshot.dirLight.diffuse));
+            glUniform3fv(lightSpecularLoc, 1, glm::value_ptr(snapshot.dirLight.specular));
 
-                glUniform3fv(glGetUniformLocation(shaderProgram, (base + "position").c_str()),
-                        1, glm::value_ptr(pointLights[i].position));
-                glUniform3fv(glGetUniformLocation(shaderProgram, (base + "color").c_str()),
-                        1, glm::value_ptr(pointLights[i].color));
+            // a variante tem o número de luzes fixo; acima do limite as luzes extras ficam de fora
+            size_t numLights = std::min<size_t>(snapshot.pointLights.size(), ShaderVariants::kMaxLights);
+            size_t numSpotLights = std::min<size_t>(snapshot.spotLights.size(), ShaderVariants::kMaxLights);
 
-                glUniform1f(glGetUniformLocation(shaderProgram, (base + "constant").c_str()),
-                        pointLights[i].constant);
-                glUniform1f(glGetUniformLocation(shaderProgram, (base + "linear").c_str()),
-                        pointLights[i].linear);
-                glUniform1f(glGetUniformLocation(shaderProgram, (base + "quadratic").c_str()),
-                        pointLights[i].quadratic);
+            // Carrega PointLights
+            for (size_t i = 0; i < numLights; i++) {
+                std::string base = "pointLights[" + std::to_string(i) + "].";
 
-                glUniform3fv(glGetUniformLocation(shaderProgram, (base + "ambient").c_str()),
-                        1, glm::value_ptr(pointLights[i].ambient));
-                glUniform3fv(glGetUniformLocation(shaderProgram, (base + "diffuse").c_str()),
-                        1, glm::value_ptr(pointLights[i].diffuse));
-                glUniform3fv(glGetUniformLocation(shaderProgram, (base + "specular").c_str()),
-                        1, glm::value_ptr(pointLights[i].specular));
+                glUniform3fv(glGetUniformLocation(program, (base + "position").c_str()),
+                        1, glm::value_ptr(snapshot.pointLights[i].position));
+                glUniform3fv(glGetUniformLocation(program, (base + "color").c_str()),
+                        1, glm::value_ptr(snapshot.pointLights[i].color));
+
+                glUniform1f(glGetUniformLocation(program, (base + "constant").c_str()),
+                        snapshot.pointLights[i].constant);
+                glUniform1f(glGetUniformLocation(program, (base + "linear").c_str()),
+                        snapshot.pointLights[i].linear);
+                glUniform1f(glGetUniformLocation(program, (base + "quadratic").c_str()),
+                        snapshot.pointLights[i].quadratic);
+
+                glUniform3fv(glGetUniformLocation(program, (base + "ambient").c_str()),
+                        1, glm::value_ptr(snapshot.pointLights[i].ambient));
+                glUniform3fv(glGetUniformLocation(program, (base + "diffuse").c_str()),
+                        1, glm::value_ptr(snapshot.pointLights[i].diffuse));
+                glUniform3fv(glGetUniformLocation(program, (base + "specular").c_str()),
+                        1, glm::value_ptr(snapshot.pointLights[i].specular));
             }
 
             // Carrega SpotLights
-            for (size_t i = 0; i < spotLights.size(); i++) {
+            for (size_t i = 0; i < numSpotLights; i++) {
                 std::string base = "spotLights[" + std::to_string(i) + "].";
 
-                glUniform3fv(glGetUniformLocation(shaderProgram, (base + "position").c_str()),
-                        1, glm::value_ptr(spotLights[i].position));
-                glUniform3fv(glGetUniformLocation(shaderProgram, (base + "direction").c_str()),
-                        1, glm::value_ptr(spotLights[i].direction));
-                glUniform3fv(glGetUniformLocation(shaderProgram, (base + "color").c_str()),
-                        1, glm::value_ptr(spotLights[i].color));
+                glUniform3fv(glGetUniformLocation(program, (base + "position").c_str()),
+                        1, glm::value_ptr(snapshot.spotLights[i].position));
+                glUniform3fv(glGetUniformLocation(program, (base + "direction").c_str()),
+                        1, glm::value_ptr(snapshot.spotLights[i].direction));
+                glUniform3fv(glGetUniformLocation(program, (base + "color").c_str()),
+                        1, glm::value_ptr(snapshot.spotLights[i].color));
+
+                glUniform1f(glGetUniformLocation(program, (base + "cutOff").c_str()),
+                        snapshot.spotLights[i].cutOff);
+                glUniform1f(glGetUniformLocation(program, (base + "outerCutOff").c_str()),
+                        snapshot.spotLights[i].outerCutOff);
+
+                glUniform1f(glGetUniformLocation(program, (base + "constant").c_str()),
+                        snapshot.spotLights[i].constant);
+                glUniform1f(glGetUniformLocation(program, (base + "linear").c_str()),
+                        snapshot.spotLights[i].linear);
+                glUniform1f(glGetUniformLocation(program, (base + "quadratic").c_str()),
+                        snapshot.spotLights[i].quadratic);
+
+                glUniform3fv(glGetUniformLocation(program, (base + "ambient").c_str()),
+                        1, glm::value_ptr(snapshot.spotLights[i].ambient));
+                glUniform3fv(glGetUniformLocation(program, (base + "diffuse").c_str()),
+                        1, glm::value_ptr(snapshot.spotLights[i].diffuse));
+                glUniform3fv(glGetUniformLocation(program, (base + "specular").c_str()),
+                        1, glm::value_ptr(snapshot.spotLights[i].specular));
+                glUniform1i(glGetUniformLocation(program, (base + "shadowLayer").c_str()),
+                        shadows.SpotLayer(i));
+            }
+        }
 
-                glUniform1f(glGetUniformLocation(shaderProgram, (base + "cutOff").c_str()),
-                        spotLights[i].cutOff);
-                glUniform1f(glGetUniformLocation(shaderProgram, (base + "outerCutOff").c_str()),
-                        spotLights[i].outerCutOff);
+        // Atualiza o que depende do tempo (câmera e rotação do céu), em segundos
+        void Update(float deltaTime) {
+            TRACE_SCOPE("Update");
+            camera->ProcessKeyboard(window, deltaTime);
+            skyRotation += skySpin * deltaTime;
 
-                glUniform1f(glGetUniformLocation(shaderProgram, (base + "constant").c_str()),
-                        spotLights[i].constant);
-                glUniform1f(glGetUniformLocation(shaderProgram, (base + "linear").c_str()),
-                        spotLights[i].linear);
-                glUniform1f(glGetUniformLocation(shaderProgram, (base + "quadratic").c_str()),
-                        spotLights[i].quadratic);
+            for (auto obj : objects) {
+                if (obj->spinSpeed != 0.0f)
+                    obj->Rotate(obj->spinSpeed * deltaTime);
+            }
+        }
 
-                glUniform3fv(glGetUniformLocation(shaderProgram, (base + "ambient").c_str()),
-                        1, glm::value_ptr(spotLights[i].ambient));
-                glUniform3fv(glGetUniformLocation(shaderProgram, (base + "diffuse").c_str()),
-                        1, glm::value_ptr(spotLights[i].diffuse));
-                glUniform3fv(glGetUniformLocation(shaderProgram, (base + "specular").c_str()),
-                        1, glm::value_ptr(spotLights[i].specular));
+        // Congela o estado da simulação (câmera, transformações, materiais, luzes) para um frame
+        void BuildSnapshot(FrameSnapshot& snapshot) {
+            TRACE_SCOPE("BuildSnapshot");
+            snapshot.view = camera->GetViewMatrix();
+            snapshot.projection = camera->GetProjectionMatrix();
+            snapshot.viewPos = camera->GetPosition();
+            snapshot.polygonMode = polygonal_mode;
+
+            snapshot.depthPrepass = options.depthPrepass;
+            snapshot.deferred = options.deferred;
+            snapshot.shadows = options.shadows;
+            snapshot.occlusion = options.occlusion && !options.softwareOcclusion;
+
+            // mesh em streaming sem layout ainda: o objeto fica de fora do frame
+            snapshot.objects.clear();
+            for (size_t i = 0; i < objects.size(); i++) {
+                if (!objects[i]->Drawable())
+                    continue;
+                snapshot.objects.emplace_back();
+                ObjectDrawState& state = snapshot.objects.back();
+                state.object = objects[i];
+                state.model = objects[i]->GetModelMatrix();
+                state.materials = objects[i]->materials;
+                state.revision = objects[i]->Revision();
+                objects[i]->GetWorldBounds(state.model, state.boundsMin, state.boundsMax);
+
+                glm::vec3 closest = glm::clamp(snapshot.viewPos, state.boundsMin, state.boundsMax);
+                state.distance = glm::length(closest - snapshot.viewPos);
+
+                // raio projetado em frações da meia altura da tela; projection[1][1] = 1/tan(fov/2)
+                glm::vec3 center = (state.boundsMin + state.boundsMax) * 0.5f;
+                float radius = glm::length(state.boundsMax - state.boundsMin) * 0.5f;
+                float centerDistance = glm::length(center - snapshot.viewPos);
+                float screenSize = centerDistance > radius ? radius * snapshot.projection[1][1] / centerDistance : 1e9f;
+                state.lod = options.lod ? objects[i]->SelectLod(screenSize) : 0;
+                state.impostor = options.impostors && objects[i]->UseImpostor(state.distance);
+                state.occluded = false;
             }
+            if (options.occlusion && options.softwareOcclusion)
+                CullOccluded(snapshot);
+
+            // Da frente para trás: o teste de profundidade descarta mais fragmentos cedo
+            std::sort(snapshot.objects.begin(), snapshot.objects.end(),
+                    [](const ObjectDrawState& a, const ObjectDrawState& b) { return a.distance < b.distance; });
+
+            GatherLights(snapshot);
+
+            snapshot.skyRotation = skyRotation;
+            snapshot.skyTint = snapshot.dirLight.ambient * skyBrightness;
         }
 
-        void RenderFrame() {
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        // Oclusão na CPU, com a câmera deste frame: os proxies dos oclusores num buffer de profundidade
+        // pequeno, e as AABBs dos outros objetos contra ele
+        void CullOccluded(FrameSnapshot& snapshot) {
+            TRACE_SCOPE("CullOccluded");
+            softwareOcclusion.Begin(snapshot.projection * snapshot.view);
+            for (const auto& state : snapshot.objects) {
+                if (state.object->occluder && !state.impostor)
+                    softwareOcclusion.AddOccluder(state.object->GetMesh().occluder, state.model);
+            }
+            softwareOcclusion.Rasterize();
+            for (auto& state : snapshot.objects) {
+                if (!state.impostor)
+                    state.occluded = softwareOcclusion.IsOccluded(state.boundsMin, state.boundsMax);
+            }
+        }
+
+        void RenderThreadMain() {
+            Tracer::SetThreadName("render");
+            glfwMakeContextCurrent(window);
+            frameTimer.ApplySwapInterval();
+
+            try {
+                while (const FrameSnapshot* snapshot = snapshots.Acquire()) {
+                    RenderFrame(*snapshot);
+                    snapshots.Release();
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Render thread error: " << e.what() << std::endl;
+                snapshots.Release();
+                glfwSetWindowShouldClose(window, GL_TRUE);
+            }
+
+            glfwMakeContextCurrent(NULL);
+        }
+
+        void RenderFrame(const FrameSnapshot& snapshot) {
+            TRACE_SCOPE("RenderFrame");
+            ApplyHotReload();
+            UploadStreamedMeshes();
+            if (memoryReportRequested.exchange(false))
+                PrintMemoryReport();
+            BuildDrawList(snapshot);
+            RequestTextureDetail(snapshot);
+            // antes do clear: o bake usa o próprio framebuffer e muda a cor de clear
+            stats.Count("impostor bakes", impostors.Update(snapshot));
             glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            stats.Count("lights", static_cast<double>(snapshot.pointLights.size() + snapshot.spotLights.size()));
+            // só os mapas cujas luzes ou objetos mudaram
+            stats.Count("shadow maps", shadows.Update(snapshot));
+
+            if (snapshot.deferred) {
+                RenderDeferred(snapshot);
+            } else {
+                RenderForward(snapshot);
+            }
+            int impostorCount = impostors.Draw(snapshot);
+            stats.Count("impostors", impostorCount);
+            stats.Count("tris", 2.0 * impostorCount);
+
+            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+            // antes do céu: só a geometria opaca conta como oclusor no próximo frame
+            if (snapshot.occlusion)
+                occlusion.Build(snapshot.projection * snapshot.view);
+            skyPass.Draw(snapshot.view, snapshot.projection, snapshot.skyRotation, snapshot.skyTint);
+
+            {
+                TRACE_SCOPE("SwapBuffers");
+                glfwSwapBuffers(window);
+            }
+
+            double now = glfwGetTime();
+            stats.EndFrame(lastFrameTime > 0.0 ? now - lastFrameTime : 0.0, framebufferWidth * framebufferHeight);
+            lastFrameTime = now;
+        }
+
+        // Objetos desenhados com o mesh neste frame: sem os impostores e sem os escondidos atrás
+        // do que estava na tela no frame anterior (a leitura da GPU chega com um frame de atraso)
+        void BuildDrawList(const FrameSnapshot& snapshot) {
+            drawList.clear();
+            if (snapshot.occlusion)
+                occlusion.Fetch();
+            else
+                occlusion.Invalidate();
+
+            int occluded = 0;
+            for (const auto& state : snapshot.objects) {
+                if (state.impostor)
+                    continue;
+                if (state.occluded || (snapshot.occlusion && occlusion.IsOccluded(state.boundsMin, state.boundsMax))) {
+                    occluded++;
+                    continue;
+                }
+                drawList.push_back(&state);
+            }
+            stats.Count("occluded", static_cast<double>(occluded));
+        }
+
+        // Uso das texturas neste frame para o streaming: quanto de uv cabe em um pixel de cada grupo
+        // desenhado, pela distância até a AABB e pela densidade de uv do grupo no mesh
+        void RequestTextureDetail(const FrameSnapshot& snapshot) {
+            if (!textureCache.Streaming())
+                return;
+            TRACE_SCOPE("RequestTextureDetail");
+            // pixels por unidade do mundo a uma unidade de distância
+            float pixelsPerUnit = 0.5f * framebufferHeight * snapshot.projection[1][1];
+            for (const ObjectDrawState* state : drawList) {
+                const Mesh& mesh = state->object->GetMesh();
+                float scale = glm::length(glm::vec3(state->model[0]));
+                if (scale <= 0.0f)
+                    continue;
+                const std::vector<GLuint>& textures = state->object->GetTextures();
+                for (size_t i = 0; i < textures.size(); i++)
+                    textureCache.RequestDetail(textures[i], mesh.UvDensity(i) / scale * state->distance / pixelsPerUnit);
+            }
+            // a grama sempre chega até a câmera
+            if (grass.Enabled())
+                textureCache.RequestDetail(grass.Texture(), 0.0f);
+            textureCache.UpdateStreaming();
+            stats.Count("texture MB", textureCache.StreamedBytes() / 1048576.0);
+            stats.Count("texture streams", static_cast<double>(textureCache.PendingStreams()));
+        }
 
-            glm::mat4 view = camera->GetViewMatrix();
-            glm::mat4 projection = camera->GetProjectionMatrix();
+        // fs.glsl: todas as luzes em cada fragmento (até kMaxLights de cada tipo),
+        // com a variante do shader escolhida por grupo de material
+        void RenderForward(const FrameSnapshot& snapshot) {
+            preparedPrograms.clear();
+            glPolygonMode(GL_FRONT_AND_BACK, snapshot.polygonMode ? GL_LINE : GL_FILL);
+
+            if (snapshot.depthPrepass) {
+                DepthPrepass(snapshot);
+                // só o fragmento visível de cada pixel passa no shading
+                glDepthFunc(GL_EQUAL);
+                glDepthMask(GL_FALSE);
+            }
+
+            stats.BeginSamples();
+            GLuint current = 0;
+            for (const ObjectDrawState* draw : drawList) {
+                const ObjectDrawState& state = *draw;
+                TRACE_SCOPE_DETAIL("Object::Draw", state.object->name.c_str());
+                GLuint modelProgram = 0;
+                for (size_t i = 0; i < state.object->GroupCount(); i++) {
+                    uint32_t key = ShaderVariants::KeyFor(state.materials[i], snapshot.pointLights.size(),
+                            snapshot.spotLights.size(), snapshot.shadows);
+                    GLuint program = forwardShaders.Get(key);
+                    if (program != current) {
+                        glUseProgram(program);
+                        current = program;
+                        PrepareForwardProgram(program, snapshot);
+                    }
+                    if (program != modelProgram) {
+                        state.object->SetModel(program, state.model);
+                        modelProgram = program;
+                    }
+                    state.object->DrawGroup(program, i, state.materials[i], state.lod);
+                }
+                stats.Count("tris", static_cast<double>(state.object->TriangleCount(state.lod)));
+            }
+            stats.EndSamples();
+
+            glDepthFunc(GL_LESS);
+            glDepthMask(GL_TRUE);
+
+            // grama fora do pre-pass: muitas lâminas pequenas, o teste comum já basta
+            if (size_t count = grass.Cull(snapshot)) {
+                uint32_t key = ShaderVariants::KeyFor(grass.Material(), snapshot.pointLights.size(),
+                        snapshot.spotLights.size(), snapshot.shadows);
+                GLuint program = grass.ForwardProgram(key);
+                glUseProgram(program);
+                PrepareForwardProgram(program, snapshot);
+                grass.Draw(program, snapshot);
+                CountGrass(count);
+            }
+            stats.Count("variants", static_cast<double>(preparedPrograms.size()));
+        }
 
-            GLint viewLoc = glGetUniformLocation(shaderProgram, "view");
-            GLint projLoc = glGetUniformLocation(shaderProgram, "projection");
-            GLint viewPosLoc = glGetUniformLocation(shaderProgram, "viewPos");
+        void CountGrass(size_t count) {
+            stats.Count("grass", static_cast<double>(count));
+            stats.Count("tris", static_cast<double>(count * grass.TrianglesPerInstance()));
+        }
 
-            glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-            glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-            glUniform3fv(viewPosLoc, 1, glm::value_ptr(camera->GetPosition()));
+        // Uniforms do frame (câmera, luzes, sombras), uma vez por variante usada
+        void PrepareForwardProgram(GLuint program, const FrameSnapshot& snapshot) {
+            if (std::find(preparedPrograms.begin(), preparedPrograms.end(), program) != preparedPrograms.end())
+                return;
+            preparedPrograms.push_back(program);
+
+            glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(snapshot.view));
+            glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE,
+                    glm::value_ptr(snapshot.projection));
+            glUniform3fv(glGetUniformLocation(program, "viewPos"), 1, glm::value_ptr(snapshot.viewPos));
+            SetupLighting(program, snapshot);
+            shadows.Bind(program);
+        }
 
-            SetupLighting();
+        // G-buffer + volumes de luz; o pre-pass não ajuda aqui, a geometria só grava atributos
+        void RenderDeferred(const FrameSnapshot& snapshot) {
+            deferred.BeginGeometry(snapshot);
+            glPolygonMode(GL_FRONT_AND_BACK, snapshot.polygonMode ? GL_LINE : GL_FILL);
 
-            glPolygonMode(GL_FRONT_AND_BACK, polygonal_mode ? GL_LINE : GL_FILL);
+            stats.BeginSamples();
+            for (const ObjectDrawState* state : drawList) {
+                state->object->Draw(deferred.GeometryProgram(), state->model, state->materials, state->lod);
+                stats.Count("tris", static_cast<double>(state->object->TriangleCount(state->lod)));
+            }
+            if (size_t count = grass.Cull(snapshot)) {
+                glUseProgram(grass.GeometryProgram());
+                grass.Draw(grass.GeometryProgram(), snapshot);
+                CountGrass(count);
+            }
+            stats.EndSamples();
 
-            for (auto obj : objects) {
-                if (obj->name == "models/sphere.obj")
-                    obj->Rotate(0.001f);
+            deferred.Resolve(snapshot, shadows);
+        }
+
+        // Uma fatia de cada mesh em streaming por frame. As sombras em cache não veem o mesh crescer
+        // (a revisão do objeto não muda), então são redesenhadas enquanto chegam triângulos
+        void UploadStreamedMeshes() {
+            if (streamingMeshes.empty())
+                return;
+            TRACE_SCOPE("UploadStreamedMeshes");
+            bool grew = false;
+            for (auto it = streamingMeshes.begin(); it != streamingMeshes.end();) {
+                Mesh& mesh = **it;
+                size_t before = mesh.ResidentVertices();
+                bool complete = mesh.UploadStreamed(options.packedVertices, kStreamBytesPerFrame);
+                grew = grew || mesh.ResidentVertices() != before;
+                if (!complete) {
+                    ++it;
+                    continue;
+                }
+                mesh.ReleaseCpuData(options.cpuVertices);
+                if (mesh.StreamFailed())  // o objeto fica só com o prefixo que chegou (talvez nada)
+                    std::cout << mesh.path << ": streaming stopped at " << mesh.ResidentVertices() / 3 << " triangles"
+                              << std::endl;
+                else
+                    std::cout << mesh.path << ": streamed " << mesh.TriangleCount(0) << " triangles ("
+                              << mesh.GpuBytes() / 1024 << " KB)" << std::endl;
+                it = streamingMeshes.erase(it);
+            }
+            if (grew)
+                shadows.Invalidate();
+            stats.Count("streaming", static_cast<double>(streamingMeshes.size()));
+        }
 
-                obj->Draw(polygonal_mode);
+        // Entre frames, na thread de render: o que o watcher já preparou vai para a GPU
+        void ApplyHotReload() {
+            for (auto& texture : hotReload.TakeTextures()) {
+                if (textureCache.Replace(texture.first, texture.second))
+                    std::cout << "Texture reloaded: " << texture.first << std::endl;
+                TextureCache::Free(texture.second);
             }
+            if (hotReload.TakeShaderChange())
+                ReloadShaders();
+        }
+
+        // Cada parte só troca seus programas se todos compilarem; com erro, continua com os antigos
+        void ReloadShaders() {
+            TRACE_SCOPE("ReloadShaders");
+            double start = glfwGetTime();
+            try {
+                vertexShader = loadShaderFromFile("vs.glsl");
+                fragmentShader = loadShaderFromFile("fs.glsl");
+                forwardShaders.Reload(vertexShader, InsertAfterVersion(fragmentShader, loadShaderFromFile("shadow.glsl")));
+
+                skyPass.SetProgram(CreateProgram(loadShaderFromFile("fullscreen_vs.glsl"), loadShaderFromFile("sky_fs.glsl")));
+                GLuint depth = CreateProgram(loadShaderFromFile("depth_vs.glsl"), loadShaderFromFile("depth_fs.glsl"));
+                glDeleteProgram(depthProgram);
+                depthProgram = depth;
+
+                deferred.BuildPrograms();
+                shadows.ReloadProgram();
+                impostors.ReloadProgram();
+                occlusion.ReloadProgram();
+                grass.ReloadPrograms();
+                PruneProgramCache();
+                std::cout << "Shaders reloaded in " << (glfwGetTime() - start) * 1000.0 << " ms" << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << "Shader reload failed: " << e.what() << std::endl;
+            }
+        }
 
-            glfwSwapBuffers(window);
-            glfwPollEvents();
+        void DepthPrepass(const FrameSnapshot& snapshot) {
+            TRACE_SCOPE("DepthPrepass");
+            glUseProgram(depthProgram);
+            glUniformMatrix4fv(glGetUniformLocation(depthProgram, "view"), 1, GL_FALSE, glm::value_ptr(snapshot.view));
+            glUniformMatrix4fv(glGetUniformLocation(depthProgram, "projection"), 1, GL_FALSE,
+                    glm::value_ptr(snapshot.projection));
+
+            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+            for (const ObjectDrawState* state : drawList) {
+                state->object->DrawDepth(depthProgram, state->model, state->lod);
+            }
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
         }
 
         void Cleanup() {
+            hotReload.Stop();
+            // as threads de carga seguram os meshes; o último dono precisa ser esta thread (contexto GL)
+            for (auto& load : streamLoads)
+                load.wait();
+            streamingMeshes.clear();
             for (auto obj : objects) {
                 delete obj;
             }
             objects.clear();
-
-            glDeleteProgram(shaderProgram);
+            meshes.clear();
+            skyPass.Destroy();
+            deferred.Destroy();
+            shadows.Destroy();
+            impostors.Destroy();
+            occlusion.Destroy();
+            grass.Destroy();
+            stats.Destroy();
+            textureCache.Clear();
+
+            forwardShaders.Destroy();
+            glDeleteProgram(depthProgram);
             delete camera;
             glfwTerminate();
         }
@@ -813,15 +1118,84 @@ class Renderer {
 
 Renderer* Renderer::instance = nullptr;
 
-int main() {
+// Opções: --vsync on|off|adaptive, --fps-cap N, --fixed-step HZ, --single-thread, --scene arquivo,
+//         --no-depth-prepass, --deferred, --no-shadows, --no-lod, --no-impostors,
+//         --no-occlusion, --cpu-occlusion, --float-vertices, --cpu-vertices none|positions|full, --stream-meshes,
+//         --texture-budget MB,
+//         --no-grass, --no-shader-cache, --no-mesh-cache, --no-hot-reload, --stats
+static RendererOptions ParseArgs(int argc, char** argv) {
+    RendererOptions options;
+    FrameTimingConfig& config = options.timing;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--vsync" && hasValue) {
+            std::string mode = argv[++i];
+            config.swapInterval = mode == "off" ? 0 : (mode == "adaptive" ? -1 : 1);
+        } else if (arg == "--fps-cap" && hasValue) {
+            config.fpsCap = std::atof(argv[++i]);
+        } else if (arg == "--fixed-step" && hasValue) {
+            config.fixedStepHz = std::atof(argv[++i]);
+        } else if (arg == "--scene" && hasValue) {
+            options.scenePath = argv[++i];
+        } else if (arg == "--no-depth-prepass") {
+            options.depthPrepass = false;
+        } else if (arg == "--deferred") {
+            options.deferred = true;
+        } else if (arg == "--no-shadows") {
+            options.shadows = false;
+        } else if (arg == "--no-lod") {
+            options.lod = false;
+        } else if (arg == "--no-impostors") {
+            options.impostors = false;
+        } else if (arg == "--no-occlusion") {
+            options.occlusion = false;
+        } else if (arg == "--cpu-occlusion") {
+            options.softwareOcclusion = true;
+        } else if (arg == "--float-vertices") {
+            options.packedVertices = false;
+        } else if (arg == "--cpu-vertices" && hasValue) {
+            std::string mode = argv[++i];
+            options.cpuVertices = mode == "full" ? CpuResidency::Full
+                                : (mode == "positions" ? CpuResidency::Positions : CpuResidency::None);
+        } else if (arg == "--stream-meshes") {
+            options.streamMeshes = true;
+        } else if (arg == "--texture-budget" && hasValue) {
+            options.textureBudgetMB = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+        } else if (arg == "--no-grass") {
+            options.grass = false;
+        } else if (arg == "--no-shader-cache") {
+            options.shaderCache = false;
+        } else if (arg == "--no-mesh-cache") {
+            options.meshCache = false;
+        } else if (arg == "--no-hot-reload") {
+            options.hotReload = false;
+        } else if (arg == "--stats") {
+            options.stats = true;
+        } else if (arg == "--single-thread") {
+            options.renderThread = false;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+        }
+    }
+    return options;
+}
+
+int main(int argc, char** argv) {
+    Tracer::SetThreadName("main");
+    RendererOptions options = ParseArgs(argc, argv);
     vertexShader = loadShaderFromFile("vs.glsl");
     fragmentShader = loadShaderFromFile("fs.glsl");
     try {
-        Renderer renderer(1920, 1080);
-        renderer.Run();
+        {
+            Renderer renderer(1920, 1080, options);
+            renderer.Run();
+        }
+        Tracer::WriteChromeTrace("trace.json");
         return 0;
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
+        Tracer::WriteChromeTrace("trace.json");
         return -1;
     }
 }
@@ -0,0 +1,55 @@
+// Amostragem dos shadow maps (ShadowMaps.cpp). Inserido depois do #version em fs.glsl
+// e nos passes de luz do deferred; 1.0 = iluminado, 0.0 = na sombra.
+// Com NO_SHADOWS (sombras desligadas) as funções viram constantes.
+#define SUN_CASCADES 3
+#define MAX_SPOT_SHADOWS 4
+
+#ifdef NO_SHADOWS
+
+float SunShadow(vec3 fragPos, vec3 normal) { return 1.0; }
+float SpotShadow(int layer, vec3 fragPos, vec3 normal) { return 1.0; }
+
+#else
+
+uniform sampler2DArrayShadow sunShadowMap;
+uniform mat4 sunShadowMatrices[SUN_CASCADES];
+uniform float sunShadowTexel[SUN_CASCADES];  // tamanho de um texel no mundo, por cascata
+uniform sampler2DArrayShadow spotShadowMap;
+uniform mat4 spotShadowMatrices[MAX_SPOT_SHADOWS];
+
+// PCF 3x3 com a comparação de profundidade do hardware
+float SampleShadow(sampler2DArrayShadow map, vec3 coords, float layer) {
+    vec2 texel = 1.0 / vec2(textureSize(map, 0).xy);
+    float lit = 0.0;
+    for (int x = -1; x <= 1; x++) {
+        for (int y = -1; y <= 1; y++) {
+            lit += texture(map, vec4(coords.xy + vec2(x, y) * texel, layer, coords.z));
+        }
+    }
+    return lit / 9.0;
+}
+
+// Primeira cascata (da menor para a maior) que contém o ponto
+float SunShadow(vec3 fragPos, vec3 normal) {
+    for (int i = 0; i < SUN_CASCADES; i++) {
+        vec4 p = sunShadowMatrices[i] * vec4(fragPos + normal * sunShadowTexel[i] * 1.5, 1.0);
+        vec3 coords = p.xyz * 0.5 + 0.5;
+        if (all(greaterThan(coords.xy, vec2(0.02))) && all(lessThan(coords.xy, vec2(0.98))) && coords.z <= 1.0)
+            return SampleShadow(sunShadowMap, coords, float(i));
+    }
+    return 1.0;
+}
+
+float SpotShadow(int layer, vec3 fragPos, vec3 normal) {
+    if (layer < 0)
+        return 1.0;
+    vec4 p = spotShadowMatrices[layer] * vec4(fragPos + normal * 0.02, 1.0);
+    if (p.w <= 0.0)
+        return 1.0;
+    vec3 coords = p.xyz / p.w * 0.5 + 0.5;
+    if (any(lessThan(coords, vec3(0.0))) || any(greaterThan(coords, vec3(1.0))))
+        return 1.0;
+    return SampleShadow(spotShadowMap, coords, float(layer));
+}
+
+#endif
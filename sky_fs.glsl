@@ -0,0 +1,23 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 ndc;
+
+uniform mat4 invViewProjection;  // inversa de projection * view sem translação
+uniform sampler2D skyTexture;     // mapa equiretangular
+uniform float rotation;           // rotação do céu em torno de Y
+uniform vec3 tint;
+
+const float PI = 3.14159265359;
+
+void main() {
+    vec4 world = invViewProjection * vec4(ndc, 1.0, 1.0);
+    vec3 dir = normalize(world.xyz / world.w);
+
+    float c = cos(rotation);
+    float s = sin(rotation);
+    dir = vec3(c * dir.x - s * dir.z, dir.y, s * dir.x + c * dir.z);
+
+    vec2 uv = vec2(atan(dir.z, dir.x) / (2.0 * PI) + 0.5, asin(clamp(dir.y, -1.0, 1.0)) / PI + 0.5);
+    FragColor = vec4(texture(skyTexture, uv).rgb * tint, 1.0);
+}
@@ -1,4 +1,6 @@
 #version 330 core
+// Atributos em float ou compactos (Mesh::Upload): posição unorm16 dentro da AABB e normal
+// octaédrica em .xy; os uniforms de Mesh::BindDecode dizem qual
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec2 texture_coord;
 layout (location = 2) in vec3 normal;
@@ -10,10 +12,25 @@ out vec2 TexCoords;
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+uniform bool packedNormals;
+
+// precisa bater com depth_vs.glsl (pre-pass usa GL_EQUAL)
+invariant gl_Position;
+
+vec3 DecodeNormal() {
+    if (!packedNormals)
+        return normal;
+    vec3 n = vec3(normal.xy, 1.0 - abs(normal.x) - abs(normal.y));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(n);
+}
 
 void main() {
-    FragPos = vec3(model * vec4(position, 1.0));
-    Normal = mat3(transpose(inverse(model))) * normal;
+    FragPos = vec3(model * vec4(positionOffset + positionScale * position, 1.0));
+    Normal = mat3(transpose(inverse(model))) * DecodeNormal();
     TexCoords = texture_coord;
 
     gl_Position = projection * view * vec4(FragPos, 1.0);